@@ -0,0 +1,139 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#ifndef COMPILER_THEORY_AST_H
+#define COMPILER_THEORY_AST_H
+
+#include "definitions.h"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Bytes in each arena block, a bigger allocation gets a block of its own
+//
+#define AST_ARENA_BLOCK_SIZE 65536
+
+// Expression nodes
+//
+#define AST_INT_LITERAL     0
+#define AST_FLOAT_LITERAL   1
+#define AST_BOOL_LITERAL    2
+#define AST_STRING_LITERAL  3
+#define AST_VARIABLE        4     // value of a variable, op is one of the AST_ACCESS_* below
+#define AST_CALL            5     // arguments are lhs and the nodes chained on its next
+#define AST_ARRAY_ARGUMENT  6     // a whole array passed to a procedure
+#define AST_NEGATE          7
+#define AST_NOT             8
+#define AST_BINARY          9     // op is the operator token
+#define AST_CONVERT         10    // lhs converted to type
+
+// How an AST_VARIABLE is reached
+//
+#define AST_ACCESS_SCALAR   0     // the variable's current address
+#define AST_ACCESS_INDEX    1     // array element, the index is lhs (bounds checked)
+#define AST_ACCESS_UNROLL   2     // array element at the index of the unrolled assignment it is in
+
+// Statement nodes
+//
+#define AST_ASSIGNMENT      0
+#define AST_IF              1
+#define AST_LOOP            2
+#define AST_RETURN          3
+#define AST_PROGRAM_RETURN  4     // return in the program body, returns 0 whatever expr is
+
+// Declaration nodes
+//
+#define AST_GLOBAL_VARIABLE 0
+#define AST_PROCEDURE       1
+
+// Expression, type is the type of its value (after any conversion the parser asked for).
+// Conversions between the operands of an AST_BINARY follow from their types, the same way the
+// parser checked them.
+struct ast_expr_t
+{
+    int kind = AST_INT_LITERAL;
+    int type = T_UNKNOWN;
+    int op = 0;
+    uint32_t symbol = 0;            // variable or procedure handle (0 is SYMBOL_NONE)
+    ast_expr_t *lhs = nullptr;      // operand, left operand, array index or first argument
+    ast_expr_t *rhs = nullptr;      // right operand
+    ast_expr_t *next = nullptr;     // next argument
+    union
+    {
+        int intValue;               // int and bool literals
+        float floatValue;
+    } val = {0};
+    const char *text = nullptr;     // string literal, without the quotes
+    uint32_t length = 0;
+};
+
+// Statement, only statements that parsed without errors make it into the tree
+struct ast_stmt_t
+{
+    int kind = AST_ASSIGNMENT;
+    ast_stmt_t *next = nullptr;
+    ast_expr_t *dest = nullptr;     // assignment destination, an AST_VARIABLE
+    ast_expr_t *expr = nullptr;     // assigned value, condition or returned value
+    ast_stmt_t *init = nullptr;     // loop assignment
+    ast_stmt_t *body = nullptr;     // then or loop statements
+    ast_stmt_t *elseBody = nullptr;
+    bool hasElse = false;
+};
+
+// Declaration, procedures hold everything declared in them
+struct ast_decl_t
+{
+    int kind = AST_GLOBAL_VARIABLE;
+    uint32_t symbol = 0;
+    ast_decl_t *next = nullptr;
+
+    int index = 0;                  // procedures are named "function<index>"
+    bool hasBody = false;           // false if the declaration failed after the header
+    ast_decl_t *decls = nullptr;
+    const uint32_t *locals = nullptr; // variables of the procedure's scope in declaration order
+    uint32_t localCount = 0;
+    const uint32_t *params = nullptr; // variable of each parameter, or SYMBOL_NONE if it failed
+    uint32_t paramCount = 0;
+    ast_stmt_t *body = nullptr;
+};
+
+struct ast_program_t
+{
+    const char *name = nullptr;
+    uint32_t length = 0;
+    ast_decl_t *decls = nullptr;
+    bool hasBody = false;           // main is only generated once the program's begin is found
+    ast_stmt_t *body = nullptr;
+};
+
+// Nodes are bump allocated from large blocks and all freed at once with the arena, so they must
+// be trivially destructible (no strings or vectors, they point into the arena instead).
+class AstArena
+{
+
+    public:
+
+        AstArena();
+        ~AstArena();
+
+        template <typename T>
+        T* New()
+        {
+            return new (Allocate(sizeof(T), alignof(T))) T();
+        }
+
+        uint32_t* NewHandles(size_t count);
+        const char* CopyString(const char* text, size_t length);
+
+    private:
+        void* Allocate(size_t size, size_t align);
+
+        std::vector<std::unique_ptr<char[]> > blocks;
+        size_t blockSize; // size of the current block
+        size_t blockUsed; // bytes used in the current block
+};
+
+#endif //COMPILER_THEORY_AST_H
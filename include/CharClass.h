@@ -0,0 +1,48 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#ifndef COMPILER_THEORY_CHARCLASS_H
+#define COMPILER_THEORY_CHARCLASS_H
+
+#include <cstddef>
+
+// Instruction sets the character class scanners can use
+//
+#define SIMD_SCALAR 0
+#define SIMD_SSE2   1
+#define SIMD_AVX2   2
+
+// Character class scanning over the source buffer, 16 (SSE2) or 32 (AVX2) bytes at a time.
+// The best instruction set is picked at runtime, the scalar versions are always available as a
+// fallback and as the reference implementation.
+//
+// Every Skip/Find function returns a pointer to the first byte in [p, end) that ends the run, or end.
+// Byte 0xFF reads as EOF in the scanner, so it always ends a run.
+class CharClass
+{
+
+    public:
+
+        static int GetSimdLevel();
+        static void SetSimdLevel(int level);
+
+        static const char* SkipSpace(const char* p, const char* end);
+        static const char* SkipIdentifier(const char* p, const char* end);
+        static const char* SkipDigits(const char* p, const char* end);
+        static const char* FindLineEnd(const char* p, const char* end);
+        static const char* FindCommentDelimiter(const char* p, const char* end);
+        static void FoldUpper(char* dst, const char* src, size_t length);
+
+        static const char* SkipSpaceScalar(const char* p, const char* end);
+        static const char* SkipIdentifierScalar(const char* p, const char* end);
+        static const char* SkipDigitsScalar(const char* p, const char* end);
+        static const char* FindLineEndScalar(const char* p, const char* end);
+        static const char* FindCommentDelimiterScalar(const char* p, const char* end);
+        static void FoldUpperScalar(char* dst, const char* src, size_t length);
+
+    private:
+        static int simdLevel;
+};
+
+#endif //COMPILER_THEORY_CHARCLASS_H
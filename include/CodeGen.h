@@ -0,0 +1,91 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#ifndef COMPILER_THEORY_CODEGEN_H
+#define COMPILER_THEORY_CODEGEN_H
+
+#include "Ast.h"
+#include "SymbolTable.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+// Lowers the tree the parser built to LLVM IR. The tree is already checked, so nothing here reports
+// errors, and it is walked in source order so the IR comes out the way it did when the parser
+// generated it while parsing.
+class CodeGen
+{
+public:
+
+    CodeGen(SymbolTable &symbolTable_, llvm::LLVMContext &llvmContext_);
+    ~CodeGen();
+
+    std::unique_ptr<llvm::Module> Generate(const ast_program_t *program);
+
+private:
+    // Where a symbol lives in the IR, by handle
+    struct symbol_ir_t
+    {
+        llvm::Value *address = nullptr;      // scalar, or the array element last assigned
+        llvm::Value *arrayAddress = nullptr;
+        llvm::Value *arraySize = nullptr;
+        llvm::Function *function = nullptr;
+    };
+
+    SymbolTable &symbolTable;
+    llvm::LLVMContext &llvmContext;
+    llvm::Module *llvmModule;
+    llvm::IRBuilder<> llvmBuilder;
+    llvm::Function *llvmCurrProc;
+    llvm::Function *oobError;
+
+    std::vector<symbol_ir_t> symbols;
+
+    // Loop of the unrolled assignment being generated
+    llvm::Value *unrollIdx;
+    llvm::Value *unrollIdxAddress;
+    llvm::BasicBlock *unrollLoopStart;
+    llvm::BasicBlock *unrollLoopEnd;
+
+    symbol_ir_t &GetSymbolIR(uint32_t handle);
+
+    void AddIOFunctions();
+    llvm::FunctionType *GetFunctionType(const Symbol &procedure, llvm::Type *returnType);
+
+    void Declarations(const ast_decl_t *decl);
+    void GlobalVariable(const ast_decl_t *decl);
+    void Procedure(const ast_decl_t *decl);
+
+    void Statements(const ast_stmt_t *stmt);
+    void AssignmentStatement(const ast_stmt_t *stmt);
+    void IfStatement(const ast_stmt_t *stmt);
+    void LoopStatement(const ast_stmt_t *stmt);
+    void ReturnStatement(const ast_stmt_t *stmt);
+
+    llvm::Value *Destination(const ast_expr_t *dest);
+    llvm::Value *IndexArray(const ast_expr_t *variable);
+    llvm::Value *UnrolledElement(const Symbol &array, const symbol_ir_t &ir);
+
+    llvm::Value *Expression(const ast_expr_t *expr);
+    llvm::Value *Operand(const ast_expr_t *expr);
+    llvm::Value *Operator(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *value);
+    llvm::Value *Variable(const ast_expr_t *expr);
+    llvm::Value *Call(const ast_expr_t *expr);
+    llvm::Value *Convert(const ast_expr_t *expr, llvm::Value *value);
+    llvm::Value *LogicalOp(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *rhs);
+    llvm::Value *ArithOp(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *rhs);
+    llvm::Value *Relation(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *rhs);
+    llvm::Value *StringCompare(int op, llvm::Value *lhs, llvm::Value *rhs);
+
+    llvm::Type *GetLLVMType(int type);
+    llvm::Value *CreateConstantInt(int numBits, int intVal, llvm::Type *type);
+    llvm::BasicBlock *CreateBasicBlock(std::string name);
+};
+
+#endif //COMPILER_THEORY_CODEGEN_H
@@ -6,17 +6,75 @@
 #define COMPILER_THEORY_PARSER_H
 
 #include "../include/definitions.h"
+#include "../include/Ast.h"
+#include "../include/CodeGen.h"
 #include "../include/Scanner.h"
 #include "../include/Symbol.h"
 #include "../include/SymbolTable.h"
 
+#include "llvm/Support/CodeGen.h"
+
+namespace llvm
+{
+    class TargetMachine;
+    class raw_pwrite_stream;
+}
+
+// How deeply blocks, declarations and expressions may nest before the parser gives up, each level
+// costs a few recursive calls (override with --max-depth)
+//
+#define PARSER_MAX_DEPTH 1000
+
+// Optimization level when none is given (-O0 to -O3)
+//
+#define PARSER_OPT_LEVEL 0
+
+// Binding power of the binary operators (<expression>, <arith_op>, <relation> and <term>)
+//
+#define PREC_NONE        0
+#define PREC_LOGICAL     1     // & |
+#define PREC_ARITH       2     // + -
+#define PREC_RELATION    3     // < > <= >= == !=
+#define PREC_TERM        4     // * /
+
+// What to do with the program once it is parsed, from the command line
+struct compile_options_t
+{
+    int maxDepth = PARSER_MAX_DEPTH;
+    bool checkOnly = false;             // only report errors and warnings, LLVM isn't touched
+    int optLevel = PARSER_OPT_LEVEL;
+    std::string cpu = "generic";        // -march/-mcpu, "native" is the CPU compiling the program
+    std::string features;               // -mattr, added to the CPU's own features, e.g. "+avx2,-fma"
+    bool linkRuntime = true;            // link the embedded runtime in before optimizing (-O1 and up)
+    std::string emitObj = "output.o";   // --emit=obj[=path], files left empty aren't written
+    std::string emitAsm;                // --emit=asm[=path]
+    std::string emitBc;                 // --emit=bc[=path]
+    std::string emitLl;                 // --emit=ll[=path], the IR after the optimizations
+    std::string executable;             // -o, link an executable (the object is temporary without --emit=obj)
+    std::string runtimeArchive;         // libruntime.a the executable is linked with
+};
+
+// Result of parsing an expression, the declaration itself stays in the symbol table
+struct expr_t
+{
+    int type = T_UNKNOWN;
+    bool isValid = true;
+    bool isIndexed = false;
+    uint32_t symbol = SYMBOL_NONE; // the variable this came from, if any
+    ast_expr_t *node = nullptr;    // null if it isn't valid
+};
+
 class Parser
 {
 public:
 
-    Parser(Scanner scanner_, SymbolTable symbolTable_, token_t *token_);
+    Parser(Scanner scanner_, SymbolTable symbolTable_, token_t *token_,
+           const compile_options_t &options_ = compile_options_t());
     ~Parser();
 
+    int GetErrorCount();
+    bool OutputFailed();
+
 private:
     Scanner scanner;
     SymbolTable symbolTable;
@@ -26,21 +84,24 @@ private:
     int errorCount;
     int warningCount;
     int unrollSize;
+    int nestingDepth;
+    compile_options_t options;
 
     bool errorFlag;
     bool doUnroll;
     bool sucessfulResync;
+    bool outputFailed; // an output that was asked for wasn't produced
+
+    // Syntax tree of the program, lowered by CodeGen once parsing is done
+    AstArena ast;
+    ast_program_t *program;
 
-    llvm::Module *llvmModule;
-    llvm::IRBuilder<> *llvmBuilder;
-    llvm::LLVMContext llvmContext;
-    llvm::Function *llvmCurrProc;
+    std::unique_ptr<llvm::LLVMContext> llvmContext; // only created when generating code
+    std::unique_ptr<llvm::Module> llvmModule;
 
-    // Needed because we need to be able to jump around
-    llvm::Value *unrollIdx;
-    llvm::Value *unrollIdxAddress;
-    llvm::BasicBlock *unrollLoopStart;
-    llvm::BasicBlock *unrollLoopEnd;
+    // Operator precedence stacks, see Expression()
+    std::vector<expr_t> exprOperands;
+    std::vector<int> exprOperators;
 
 
     // General/Utility Functions
@@ -48,70 +109,67 @@ private:
     std::string TypeToString(int tokenType);
 
     // Error/Warning Reporting Functions
-    void ReportError(std::string msg);
+    void ReportError(std::string msg, token_t *at = nullptr); // at the current token unless at is given
     void ReportMissingTokenError(std::string expected);
     void ReportIncompatibleTypeError(std::string op, std::string type1, std::string type2);
 
     void ReportWarning(std::string msg);
 
     bool DoResync(bool isDec);
+    bool IsNestedTooDeep();
 
     // Parsing
     void Program();
     void ProgramHeader();
     void ProgramBody();
 
-    void Declaration();
-    void Declarations();
-    void Statements(bool singleTerminator);
-    void ProcedureDeclaration(Symbol &procedure);
+    ast_decl_t* Declaration();
+    ast_decl_t* Declarations();
+    ast_stmt_t* Statements(bool singleTerminator);
+    ast_decl_t* ProcedureDeclaration(Symbol &procedure);
     void ProcedureHeader(Symbol &procedure);
     void ParameterList(Symbol &procedure);
     void Parameter(Symbol &procedure);
-    void ProcedureBody();
-    void VariableDeclaration(Symbol &variable);
+    void ProcedureBody(ast_decl_t *decl);
+    ast_decl_t* VariableDeclaration(Symbol &variable);
     void TypeMark(Symbol &symbol);
     void Bound(Symbol &symbol);
 
-    void Statement();
-    void AssignmentStatement();
-    void IfStatement();
-    void LoopStatement();
-    void ReturnStatement();
-
-    void IndexArray(Symbol &symbol);
-
-    void Identifiers(Symbol &out);
-    Symbol Destination();
+    ast_stmt_t* Statement();
+    ast_stmt_t* AssignmentStatement();
+    ast_stmt_t* IfStatement();
+    ast_stmt_t* LoopStatement();
+    ast_stmt_t* ReturnStatement();
 
-    void Expression(Symbol expectedType, Symbol &out);
-    void Expression_(Symbol expectedType, Symbol &out);
+    void IndexArray(expr_t &symbol);
 
-    void ArithOp(Symbol expectedType, Symbol &out);
-    void ArithOp_(Symbol expectedType, Symbol &out);
+    void Identifiers(expr_t &out);
+    expr_t Destination();
 
-    void Relation(Symbol expectedType, Symbol &out);
-    void Relation_(Symbol expectedType, Symbol &out);
+    void Expression(int expectedType, expr_t &out);
+    void ReduceOperator(int expectedType, bool isNotOp);
 
-    void ValidateAssignment(Symbol lhs, Symbol &rhs);
-    void ValidateExpression(Symbol expectedType, Symbol arithOp, Symbol expr_, token_t *op, bool isNotOp, Symbol &out);
-    void ValidateArithOp(Symbol expectedType, Symbol rel, Symbol arithOp_, token_t *op, Symbol &out);
-    void ValidateRelation(Symbol expectedType, Symbol term, Symbol relation_, token_t *op, Symbol &out);
+    void ValidateAssignment(int lhsType, expr_t &rhs);
+    void ValidateExpression(int expectedType, expr_t arithOp, expr_t expr_, int op, bool isNotOp, expr_t &out);
+    void ValidateArithOp(int expectedType, expr_t rel, expr_t arithOp_, int op, expr_t &out);
+    void ValidateRelation(expr_t term, expr_t relation_, int op, expr_t &out);
 
-    void Term(Symbol expectedType, Symbol &out);
-    void Term_(Symbol expectedType, Symbol &out);
+    void Factor(int expectedType, expr_t &out);
+    void Number(expr_t &out);
+    void String(expr_t &out);
 
-    void Factor(Symbol expectedType, Symbol &out);
-    void Number(Symbol &out);
-    void String(Symbol &out);
+    uint32_t Identifier();
 
-    std::string Identifier();
+    ast_expr_t* ArgumentList(std::vector<Symbol> &arguments);
 
-    std::vector<llvm::Value *> ArgumentList(std::vector<Symbol> &arguments);
+    bool LinkRuntime();
+    bool EmitCode(llvm::TargetMachine *targetMachine, llvm::Module &module, llvm::raw_pwrite_stream &dest,
+                  llvm::CodeGenFileType fileType);
+    bool LinkExecutable(const std::string &objectFile);
+    void Optimize(llvm::TargetMachine *targetMachine);
 
-    llvm::Type* GetLLVMType(Symbol symbol);
-    llvm::Value* CreateConstantInt(int numBits, int intVal, llvm::Type *type);
-    llvm::BasicBlock* CreateBasicBlock(std::string name);
+    expr_t GetSymbolExpr(uint32_t handle);
+    ast_expr_t* NewExpr(int kind, int type, ast_expr_t *lhs = nullptr, ast_expr_t *rhs = nullptr);
 
 };
 
@@ -7,9 +7,35 @@
 
 
 #include "definitions.h"
+#include "TokenArena.h"
+#include "StringInterner.h"
 
+#include <cstdint>
 #include <cstdio>
-#include <map>
+#include <memory>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+
+// Number of tokens the scanner can hold in its lookahead queue
+//
+#define SCANNER_LOOKAHEAD 4
+
+// Bytes read per refill when streaming a pipe, also the initial size of the sliding window
+//
+#define SCANNER_CHUNK_SIZE (64 * 1024)
+
+// Smallest chunk PreTokenize() hands to a worker thread
+//
+#define SCANNER_PARALLEL_MIN_CHUNK (1024 * 1024)
+
+// Tokens the ring buffer between the lexer thread and the parser holds, see StartPipeline()
+//
+#define SCANNER_PIPELINE_SIZE 4096
+
+// Largest source the scanner reads, token and comment offsets are 32 bits
+//
+#define SCANNER_MAX_SOURCE ((size_t)UINT32_MAX)
 
 class Scanner
 {
@@ -23,22 +49,109 @@ class Scanner
 
         bool InitScanner(std::string fileName);
         token_t* GetToken();
-        token_t* PeekToken();
+        token_t* PeekToken(int k = 0);
+
+        llvm::StringRef GetTokenText(const token_t* token);
+        void GetTokenLocation(const token_t* token, int& line, int& col);
+        const std::string& GetIdentifier(const token_t* token);
+        std::shared_ptr<StringInterner> GetInterner();
+
+        void SetDfaLexer(bool enable);
+        bool GetDfaLexer();
+
+        void SetCollectComments(bool enable);
+        const std::vector<trivia_t>& GetComments();
+        bool PreTokenize(int threads);
+        bool StartPipeline();
+
+        size_t GetBytesScanned();
+        size_t GetSourceSize();
+        bool IsSourceTooLarge();
+
+        static int LookupReserved(const char* text, size_t length); // public for bench-keywords
 
     private:
-        FILE* filePtr;
-        int lineCount; // starts at 1
-        int colCount; // starts at 1
-        int prevColCount;
-        std::map<std::string, int> reservedTable;
-
-        std::map<std::string, int> GenerateReservedTable();
-        int ScanOneToken(FILE* filePtr, token_t* token);
+        // Sliding window over an input that can't be mapped (pipes, stdin)
+        struct StreamWindow
+        {
+            int fd;
+            bool eof;
+            bool tooLarge; // the input went on past SCANNER_MAX_SOURCE, it was cut off there
+            std::vector<char> buffer;
+            ~StreamWindow();
+        };
+
+        // Trivia dropped from the middle of the stream window, see RefillWindow()
+        struct WindowHole
+        {
+            size_t pos;       // window index of the first byte after the hole
+            size_t offset;    // source offset the hole starts at
+            size_t size;      // bytes dropped
+            size_t lines;     // newlines dropped
+            size_t lineStart; // source offset of the line after the last newline dropped
+        };
+
+        // Ring buffer filled by a lexer thread, see ScannerPipeline.cpp
+        struct Pipeline;
+
+        std::shared_ptr<const char> source; // mmapped source file, or the start of the stream window
+        const char* sourceEnd;
+        const char* cursor;
+        std::shared_ptr<StreamWindow> stream; // null unless the input is being streamed
+        size_t windowBase; // source offset of source.get(), always 0 unless streaming
+        size_t retainOffset; // source offset of the last token handed out, the window keeps its text
+        std::vector<WindowHole> holes; // trivia dropped after retainOffset, in window order
+        size_t tokenStart; // source offset of the token being scanned, where a comment being skipped starts
+        bool hitWindowEnd; // current token ran into sourceEnd
+        std::shared_ptr<std::vector<token_t> > preTokens; // tokens lexed ahead by PreTokenize(), null if not used
+        size_t preTokenIndex; // next token to take from preTokens
+        std::shared_ptr<std::vector<uint32_t> > preTokenBytes; // source bytes scanning each of preTokens consumed
+        std::shared_ptr<Pipeline> pipeline; // lexer thread started by StartPipeline(), null if not used
+        std::shared_ptr<std::vector<trivia_t> > comments; // every comment skipped, null unless collecting
+        std::shared_ptr<TokenArena> tokenArena; // every token handed out for this compilation
+        std::shared_ptr<StringInterner> interner; // identifier names, shared with the symbol table
+        std::shared_ptr<std::vector<uint32_t> > lineStarts; // source offset of every line, built by the first GetLocation()
+        size_t windowLine; // line number of windowLineStart, only kept up when streaming
+        size_t windowLineStart; // source offset of the line windowBase is on
+        std::string foldBuffer; // reused to upper case identifiers before interning
+        bool readPastEnd; // last ScanNextChar() hit the end of the buffer
+        bool useDfa;
+
+        // Ring buffer of tokens that have been scanned but not yet consumed
+        token_t lookahead[SCANNER_LOOKAHEAD];
+        int lookaheadHead;
+        int lookaheadCount;
+        size_t bytesScanned;
+
+        int ScanIdentifier(token_t* token, const char* text, size_t length);
+        int ScanOperator(char ch);
+        int ScanLineComment();
+        int ScanBlockComment();
+        int ConvertNumber(token_t* token, const char* start, bool isFloatingPoint);
+        int ConvertFloat(token_t* token, const char* start);
+        bool LoadSource(int fd);
+        bool RefillWindow(size_t dropFrom);
+        bool StreamHasMore();
+        bool ContinueTrivia(size_t triviaStart);
+        size_t WindowOffset(const char* p);
+        const char* WindowPointer(size_t offset);
+        void CountLines(size_t offset, size_t& line, size_t& lineStart);
+        void CountNewlines(const char* from, const char* to, size_t& line, size_t& lineStart);
+        void GetLocation(size_t offset, int& line, int& col);
+        token_t* AllocateToken();
+        int ScanOneToken(token_t* token);
+        int ScanOneTokenDfa(token_t* token);
+        void ScanToken(token_t* token);
+        void FillLookahead(int k);
+        void LexChunk(size_t begin, size_t end, bool last, std::vector<token_t>& tokens, std::vector<uint32_t>& bytes);
+        void RunPipeline(Pipeline* pipe);
+        bool TakePipelineToken(token_t* token);
         bool isNum(char c);
         bool isAlpha(char c);
         bool isSingleToken(char c);
         bool isSpace(char c);
         char ScanNextChar();
+        void AdvanceTo(const char* p);
         void UndoScan(char c);
 };
 
@@ -0,0 +1,38 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#ifndef COMPILER_THEORY_STRINGINTERNER_H
+#define COMPILER_THEORY_STRINGINTERNER_H
+
+#include "definitions.h"
+
+#include <string>
+#include <vector>
+
+// Maps each distinct name to a 32-bit atom, so names can be compared and looked up as integers.
+// Atoms start at 1, ATOM_NONE (0) is never handed out.
+class StringInterner
+{
+
+    public:
+
+        StringInterner();
+        ~StringInterner();
+
+        uint32_t Intern(const char* text, size_t length);
+        uint32_t Intern(const std::string& name);
+
+        const std::string& GetName(uint32_t atom);
+        size_t GetCount();
+
+    private:
+        std::vector<std::string> names;   // indexed by atom
+        std::vector<uint32_t> hashes;     // indexed by atom
+        std::vector<uint32_t> slots;      // open addressing table of atoms, ATOM_NONE is empty
+
+        static uint32_t Hash(const char* text, size_t length);
+        void Grow();
+};
+
+#endif //COMPILER_THEORY_STRINGINTERNER_H
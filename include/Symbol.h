@@ -10,8 +10,6 @@
 #include <string>
 #include <vector>
 
-#include <llvm/IR/Value.h>
-
 class Symbol
 {
 public:
@@ -22,6 +20,9 @@ public:
     const std::string &GetId() const;
     void SetId(const std::string &id);
 
+    uint32_t GetAtom() const;
+    void SetAtom(uint32_t atom);
+
     int GetArraySize() const;
     void SetArraySize(int arraySize);
 
@@ -47,28 +48,15 @@ public:
     void SetIsArrayIndexed(bool isIndexed);
 
     std::vector<Symbol> &GetParameters();
+    const std::vector<Symbol> &GetParameters() const;
     void SetParameters(const std::vector<Symbol> &parameters);
 
-    llvm::Value *GetAddress() const;
-    void SetAddress(llvm::Value *address);
-
-    llvm::Value *GetValue() const;
-    void SetValue(llvm::Value *value);
-
-    llvm::Value *GetArrayAddress() const;
-    void SetArrayAddress(llvm::Value *arrayAddress);
-
-    llvm::Value *GetLLVMArraySize() const;
-    void SetLLVMArraySize(llvm::Value *llvmArraySize);
-
-    llvm::Function *GetFunction() const;
-    void SetFunction(llvm::Function *function) ;
-
     void CopySymbol(Symbol toCopy);
 
 private:
 
     std::string id;
+    uint32_t atom; // interned id, symbol table key
 
     int arraySize;
     int declarationType;
@@ -81,13 +69,6 @@ private:
     bool isIndexed;
 
     std::vector<Symbol> parameters;
-
-    // LLVM
-    llvm::Value *address;
-    llvm::Value *value;
-    llvm::Value *arrayAddress;
-    llvm::Value *llvmArraySize;
-    llvm::Function *function;
 };
 
 #endif //COMPILER_THEORY_SYMBOL_H
@@ -6,13 +6,39 @@
 #define COMPILER_THEORY_SYMBOLTABLE_H
 
 #include "Symbol.h"
+#include "StringInterner.h"
 
-#include <map>
+#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
-#include <llvm/IR/IRBuilder.h>
+#include <llvm/ADT/ArrayRef.h>
 
+// Handle of no symbol, GetSymbol() returns an invalid symbol for it
+//
+#define SYMBOL_NONE 0
+
+// No binding in an enclosing scope
+//
+#define SCOPE_ENTRY_NONE 0xFFFFFFFF
+
+// A name bound in a local scope
+//
+struct scope_entry_t
+{
+    uint32_t atom;
+    uint32_t handle;
+    int scope;         // scope count when it was bound
+    uint32_t shadowed; // entry for the same name in an enclosing scope, or SCOPE_ENTRY_NONE
+};
+
+// Every symbol is stored once in an arena and referred to by its handle (index), so looking one up
+// or updating it doesn't copy its name and parameters.
+//
+// Names are looked up in a single open addressing table keyed by atom, each slot holds the global
+// binding and the innermost local one. Local bindings are pushed onto a log, removing a scope pops
+// its entries and puts back the bindings they shadowed, so that only costs the names in that scope.
 class SymbolTable {
 
 public:
@@ -20,33 +46,61 @@ public:
     SymbolTable();
     ~SymbolTable();
 
+    void SetInterner(std::shared_ptr<StringInterner> interner);
+
     void AddScope();
     void RemoveScope();
 
-    void AddSymbol(Symbol &symbol);
+    uint32_t AddSymbol(const Symbol &symbol);
+    void AddSymbol(uint32_t handle);
+    uint32_t NewSymbol(const Symbol &symbol);
 
-    void SetScopeProc(Symbol proc);
-    Symbol GetScopeProc();
+    Symbol &GetSymbol(uint32_t handle);
 
-    bool DoesSymbolExist(std::string id);
+    void SetScopeProc(uint32_t handle);
+    uint32_t GetScopeProc();
 
-    Symbol FindSymbol(std::string id);
+    bool DoesSymbolExist(uint32_t atom);
 
-    std::map<std::string, Symbol> GetLocalScope();
+    uint32_t FindSymbol(uint32_t atom);
+    uint32_t FindSymbol(const std::string &id);
 
-    void AddIOFunctions(llvm::Module *llvmModule, llvm::IRBuilder<> * llvmBuilder);
+    llvm::ArrayRef<scope_entry_t> GetLocalScope();
+
+    void AddIOFunctions();
+    llvm::ArrayRef<uint32_t> GetIOFunctions();
 
     int GetScopeCount();
 
 private:
-    std::map<std::string, Symbol> globalScope;
-    std::vector<std::map<std::string, Symbol> > localScopes;
-
-    Symbol GeneratePutSymbol(std::string id, int type, Symbol args, llvm::Module *llvmModule,
-                             llvm::IRBuilder<> *llvmBuilder, llvm::ArrayRef<llvm::Type *> llvmArgType);
-
-    Symbol GenerateGetSymbol(std::string id, int type, llvm::Module *llvmModule,
-                             llvm::IRBuilder<> *llvmBuilder, llvm::Type *llvmTy);
+    std::deque<Symbol> symbols; // arena, a deque so references stay valid as it grows
+
+    struct slot_t
+    {
+        uint32_t atom;   // ATOM_NONE if the slot is empty
+        uint32_t global; // handle, or SYMBOL_NONE
+        uint32_t local;  // index into scopeLog, or SCOPE_ENTRY_NONE
+    };
+
+    std::vector<slot_t> slots; // open addressing table, slots are never emptied once used
+    size_t slotCount;          // slots in use
+    std::vector<scope_entry_t> scopeLog; // local bindings, innermost scope last
+    std::vector<size_t> scopeStarts;     // where each scope starts in scopeLog
+
+    std::shared_ptr<StringInterner> interner; // shared with the scanner, keys are atoms
+    uint32_t procedureAtom; // key of the scope's procedure
+    uint32_t mainAtom;
+
+    slot_t *FindSlot(uint32_t atom);
+    slot_t &GetSlot(uint32_t atom);
+    uint32_t FindLocal(const slot_t *slot);
+    void BindLocal(uint32_t atom, uint32_t handle);
+    void Grow();
+
+    std::vector<uint32_t> ioFunctions; // runtime procedures, see AddIOFunctions()
+
+    Symbol GeneratePutSymbol(std::string id, int type, Symbol args);
+    Symbol GenerateGetSymbol(std::string id, int type);
 
     int scopeCount;
 };
@@ -0,0 +1,36 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#ifndef COMPILER_THEORY_TOKENARENA_H
+#define COMPILER_THEORY_TOKENARENA_H
+
+#include "definitions.h"
+
+#include <memory>
+#include <vector>
+
+// Number of tokens in each arena block
+//
+#define TOKEN_ARENA_BLOCK_SIZE 4096
+
+class TokenArena
+{
+
+    public:
+
+        TokenArena();
+        ~TokenArena();
+
+        token_t* Allocate();
+        void Reset();
+
+        size_t GetTokenCount();
+
+    private:
+        std::vector<std::unique_ptr<token_t[]> > blocks;
+        size_t blockIndex; // block currently being filled
+        size_t blockUsed;  // tokens used in the current block
+};
+
+#endif //COMPILER_THEORY_TOKENARENA_H
@@ -8,6 +8,7 @@
 #ifndef COMPILER_THEORY_DEFINITIONS_H
 #define COMPILER_THEORY_DEFINITIONS_H
 
+#include <cstdint>
 #include <iostream>
 
 // Single Character ASCII Tokens
@@ -66,6 +67,31 @@
 #define T_ENUM           299     // "ENUM"
 
 
+// Reserved word list, the scanner generates its keyword hash table from this at compile time
+//
+#define RESERVED_WORDS(X)           \
+    X("PROGRAM",   T_PROGRAM)       \
+    X("IS",        T_IS)            \
+    X("BEGIN",     T_BEGIN)         \
+    X("END",       T_END)           \
+    X("GLOBAL",    T_GLOBAL)        \
+    X("PROCEDURE", T_PROCEDURE)     \
+    X("VARIABLE",  T_VARIABLE)      \
+    X("TYPE",      T_TYPE)          \
+    X("IF",        T_IF)            \
+    X("THEN",      T_THEN)          \
+    X("ELSE",      T_ELSE)          \
+    X("RETURN",    T_RETURN)        \
+    X("NOT",       T_NOT)           \
+    X("TRUE",      T_TRUE)          \
+    X("FALSE",     T_FALSE)         \
+    X("FOR",       T_FOR)           \
+    X("INTEGER",   T_INTEGER)       \
+    X("FLOAT",     T_FLOAT)         \
+    X("STRING",    T_STRING)        \
+    X("BOOL",      T_BOOL)
+
+
 // Miscellaneous
 //
 #define T_IDENTIFIER     300      // identifier
@@ -74,27 +100,44 @@
 #define T_STRING_LITERAL 303      // string literal
 #define T_UNKNOWN        304      // unknown identifier/invalid characters
 #define T_EOF            305      // end of file
-#define T_COMMENT        306      // comment
+#define T_COMMENT        306      // comment, only used inside the scanner
 #define T_ENUM_DEC       307      // enum declaration
 
 
 #define LLVM_INT
 
 
+// Atom for "no name", see StringInterner
+//
+#define ATOM_NONE        0
+
+
 // Token Structure
 //
+// Tokens are allocated from the scanner's TokenArena. The token text is not copied,
+// it is the [offset, offset + length) range of the source buffer (see Scanner::GetTokenText()).
+//
 struct token_t
 {
-    int type;   // token defined above
-    int col;    // starting column
-    int line;   // line number
-    std::string str;
+    int type;           // token defined above
+    uint32_t offset;    // byte offset of the token text in the source buffer
+    uint32_t length;    // length of the token text
 
     union {
-        char stringValue[256];  // holds value if string/identifier
-        int intValue;           // holds value if integer
-        float floatValue;       // holds value if float
+        int intValue;       // holds value if integer
+        float floatValue;   // holds value if float
+        uint32_t atom;      // holds interned (upper case) name if identifier
     } val;
 };
 
+
+
+// Comment position, only recorded when asked for (see Scanner::SetCollectComments())
+//
+struct trivia_t
+{
+    uint32_t offset;    // byte offset of the comment in the source buffer
+    uint32_t length;    // length including the delimiters
+};
+
 #endif //COMPILER_THEORY_DEFINITIONS_H
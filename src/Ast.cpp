@@ -0,0 +1,96 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      Arena the parser builds the syntax tree in. The tree has the symbols resolved (handles into
+//      the symbol table) and every expression typed, CodeGen lowers it to LLVM IR afterwards.
+//
+
+#include "../include/Ast.h"
+
+#include <algorithm>
+#include <cstring>
+
+/* Constructor
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+AstArena::AstArena()
+{
+    blockSize = 0;
+    blockUsed = 0;
+}
+
+/* Destructor
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+AstArena::~AstArena()
+{
+}
+
+
+/*
+Method: Allocate()
+Description: Returns size bytes from the current block, starting a new block when it doesn't fit.
+             Memory stays valid for as long as the arena does.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void* AstArena::Allocate(size_t size, size_t align)
+{
+    size_t offset = (blockUsed + align - 1) & ~(align - 1);
+    if (blocks.empty() || offset + size > blockSize)
+    {
+        // new[] is aligned for any node type, so the block starts aligned
+        blockSize = std::max<size_t>(AST_ARENA_BLOCK_SIZE, size);
+        blocks.emplace_back(new char[blockSize]);
+        offset = 0;
+    }
+
+    blockUsed = offset + size;
+    return blocks.back().get() + offset;
+}
+
+
+/*
+Method: NewHandles()
+Description: Array of count symbol handles, e.g. the locals of a procedure
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+uint32_t* AstArena::NewHandles(size_t count)
+{
+    return static_cast<uint32_t*>(Allocate(count * sizeof(uint32_t), alignof(uint32_t)));
+}
+
+
+/*
+Method: CopyString()
+Description: Copy of text that lives as long as the tree does (the scanner may have reused its
+             buffer by the time the tree is lowered)
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+const char* AstArena::CopyString(const char* text, size_t length)
+{
+    char* copy = static_cast<char*>(Allocate(length + 1, 1));
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
@@ -0,0 +1,338 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#include "../include/CharClass.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHARCLASS_X86 1
+#include <immintrin.h>
+#else
+#define CHARCLASS_X86 0
+#endif
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+
+/*
+Method: DetectSimdLevel()
+Description: Best instruction set supported by the CPU we are running on
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+static int DetectSimdLevel()
+{
+#if CHARCLASS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return SIMD_SSE2;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+int CharClass::simdLevel = DetectSimdLevel();
+
+
+/*
+Method: GetSimdLevel()
+Description: Instruction set currently used by the character class scanners
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+int CharClass::GetSimdLevel()
+{
+    return simdLevel;
+}
+
+
+/*
+Method: SetSimdLevel()
+Description: Force an instruction set (e.g. SIMD_SCALAR to compare against the reference
+             implementation). Levels the CPU doesn't support are clamped to the best one it does.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void CharClass::SetSimdLevel(int level)
+{
+    int supported = DetectSimdLevel();
+    simdLevel = (level < supported) ? level : supported;
+}
+
+
+// Scalar reference implementations
+//
+static inline bool IsEofByte(char c)
+{
+    return (unsigned char)c == 0xFF;
+}
+
+const char* CharClass::SkipSpaceScalar(const char* p, const char* end)
+{
+    // same test as Scanner::isSpace(), so bytes >= 0x80 (other than 0xFF) count as space
+    while (p != end && (int)*p <= 32 && !IsEofByte(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+const char* CharClass::SkipIdentifierScalar(const char* p, const char* end)
+{
+    while (p != end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') ||
+                        (*p >= '0' && *p <= '9') || *p == '_'))
+    {
+        p++;
+    }
+    return p;
+}
+
+const char* CharClass::SkipDigitsScalar(const char* p, const char* end)
+{
+    while (p != end && ((*p >= '0' && *p <= '9') || *p == '_'))
+    {
+        p++;
+    }
+    return p;
+}
+
+const char* CharClass::FindLineEndScalar(const char* p, const char* end)
+{
+    while (p != end && *p != '\n' && !IsEofByte(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+const char* CharClass::FindCommentDelimiterScalar(const char* p, const char* end)
+{
+    while (p != end && *p != '*' && *p != '/' && !IsEofByte(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+void CharClass::FoldUpperScalar(char* dst, const char* src, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        char c = src[i];
+        dst[i] = (c >= 'a' && c <= 'z') ? (char)(c - ('a' - 'A')) : c;
+    }
+}
+
+
+#if CHARCLASS_X86
+
+// SSE2, 16 bytes at a time
+//
+// Each Stop function returns a bitmask with a bit set for every byte that ends the run.
+// Comparisons are signed, so bytes >= 0x80 never fall inside a letter or digit range.
+//
+static inline unsigned StopSpace16(__m128i v)
+{
+    __m128i stop = _mm_or_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(32)), _mm_cmpeq_epi8(v, _mm_set1_epi8(-1)));
+    return _mm_movemask_epi8(stop);
+}
+
+static inline __m128i InRange16(__m128i v, char lo, char hi)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+static inline unsigned StopIdentifier16(__m128i v)
+{
+    __m128i alpha = InRange16(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i word = _mm_or_si128(_mm_or_si128(alpha, InRange16(v, '0', '9')), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    return ~_mm_movemask_epi8(word) & 0xFFFF;
+}
+
+static inline unsigned StopDigits16(__m128i v)
+{
+    __m128i digits = _mm_or_si128(InRange16(v, '0', '9'), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    return ~_mm_movemask_epi8(digits) & 0xFFFF;
+}
+
+static inline unsigned StopLineEnd16(__m128i v)
+{
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8(-1)));
+    return _mm_movemask_epi8(stop);
+}
+
+static inline unsigned StopCommentDelimiter16(__m128i v)
+{
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')), _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8(-1)));
+    return _mm_movemask_epi8(stop);
+}
+
+#define SSE2_SCAN(name, stop)                                                   \
+    static const char* name##Sse2(const char* p, const char* end)             \
+    {                                                                           \
+        while (end - p >= 16)                                                   \
+        {                                                                       \
+            unsigned mask = stop(_mm_loadu_si128((const __m128i*)p));           \
+            if (mask != 0)                                                      \
+            {                                                                   \
+                return p + __builtin_ctz(mask);                                 \
+            }                                                                   \
+            p += 16;                                                            \
+        }                                                                       \
+        return CharClass::name##Scalar(p, end);                                 \
+    }
+
+SSE2_SCAN(SkipSpace, StopSpace16)
+SSE2_SCAN(SkipIdentifier, StopIdentifier16)
+SSE2_SCAN(SkipDigits, StopDigits16)
+SSE2_SCAN(FindLineEnd, StopLineEnd16)
+SSE2_SCAN(FindCommentDelimiter, StopCommentDelimiter16)
+
+static void FoldUpperSse2(char* dst, const char* src, size_t length)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lower = InRange16(v, 'a', 'z');
+        v = _mm_sub_epi8(v, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    CharClass::FoldUpperScalar(dst + i, src + i, length - i);
+}
+
+
+// AVX2, 32 bytes at a time
+//
+TARGET_AVX2 static inline unsigned StopSpace32(__m256i v)
+{
+    __m256i stop = _mm256_or_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(32)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(-1)));
+    return _mm256_movemask_epi8(stop);
+}
+
+TARGET_AVX2 static inline __m256i InRange32(__m256i v, char lo, char hi)
+{
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+TARGET_AVX2 static inline unsigned StopIdentifier32(__m256i v)
+{
+    __m256i alpha = InRange32(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i word = _mm256_or_si256(_mm256_or_si256(alpha, InRange32(v, '0', '9')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return ~(unsigned)_mm256_movemask_epi8(word);
+}
+
+TARGET_AVX2 static inline unsigned StopDigits32(__m256i v)
+{
+    __m256i digits = _mm256_or_si256(InRange32(v, '0', '9'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return ~(unsigned)_mm256_movemask_epi8(digits);
+}
+
+TARGET_AVX2 static inline unsigned StopLineEnd32(__m256i v)
+{
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(-1)));
+    return _mm256_movemask_epi8(stop);
+}
+
+TARGET_AVX2 static inline unsigned StopCommentDelimiter32(__m256i v)
+{
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+    stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(-1)));
+    return _mm256_movemask_epi8(stop);
+}
+
+#define AVX2_SCAN(name, stop)                                                   \
+    TARGET_AVX2 static const char* name##Avx2(const char* p, const char* end) \
+    {                                                                           \
+        while (end - p >= 32)                                                   \
+        {                                                                       \
+            unsigned mask = stop(_mm256_loadu_si256((const __m256i*)p));        \
+            if (mask != 0)                                                      \
+            {                                                                   \
+                return p + __builtin_ctz(mask);                                 \
+            }                                                                   \
+            p += 32;                                                            \
+        }                                                                       \
+        return name##Sse2(p, end);                                              \
+    }
+
+AVX2_SCAN(SkipSpace, StopSpace32)
+AVX2_SCAN(SkipIdentifier, StopIdentifier32)
+AVX2_SCAN(SkipDigits, StopDigits32)
+AVX2_SCAN(FindLineEnd, StopLineEnd32)
+AVX2_SCAN(FindCommentDelimiter, StopCommentDelimiter32)
+
+TARGET_AVX2 static void FoldUpperAvx2(char* dst, const char* src, size_t length)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i lower = InRange32(v, 'a', 'z');
+        v = _mm256_sub_epi8(v, _mm256_and_si256(lower, _mm256_set1_epi8(0x20)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    FoldUpperSse2(dst + i, src + i, length - i);
+}
+
+#define DISPATCH(name, ...)                                                     \
+    switch (simdLevel)                                                          \
+    {                                                                           \
+        case SIMD_AVX2: return name##Avx2(__VA_ARGS__);                         \
+        case SIMD_SSE2: return name##Sse2(__VA_ARGS__);                         \
+        default: return name##Scalar(__VA_ARGS__);                              \
+    }
+
+#else
+
+#define DISPATCH(name, ...) return name##Scalar(__VA_ARGS__);
+
+#endif
+
+
+// Dispatching entry points
+//
+const char* CharClass::SkipSpace(const char* p, const char* end)
+{
+    DISPATCH(SkipSpace, p, end)
+}
+
+const char* CharClass::SkipIdentifier(const char* p, const char* end)
+{
+    DISPATCH(SkipIdentifier, p, end)
+}
+
+const char* CharClass::SkipDigits(const char* p, const char* end)
+{
+    DISPATCH(SkipDigits, p, end)
+}
+
+const char* CharClass::FindLineEnd(const char* p, const char* end)
+{
+    DISPATCH(FindLineEnd, p, end)
+}
+
+const char* CharClass::FindCommentDelimiter(const char* p, const char* end)
+{
+    DISPATCH(FindCommentDelimiter, p, end)
+}
+
+void CharClass::FoldUpper(char* dst, const char* src, size_t length)
+{
+    DISPATCH(FoldUpper, dst, src, length)
+}
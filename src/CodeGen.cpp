@@ -0,0 +1,821 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      Lowers the syntax tree to LLVM IR. Symbols and types were resolved and checked by the
+//      parser, so this only has to follow the tree: declarations in order (a procedure's nested
+//      procedures before its own entry block), then statements, with every operand generated
+//      before the operator that uses it.
+//
+
+#include "../include/CodeGen.h"
+
+CodeGen::CodeGen(SymbolTable &symbolTable_, llvm::LLVMContext &llvmContext_)
+    : symbolTable(symbolTable_), llvmContext(llvmContext_), llvmBuilder(llvmContext_)
+{
+    llvmModule = nullptr;
+    llvmCurrProc = nullptr;
+    oobError = nullptr;
+
+    unrollIdx = nullptr;
+    unrollIdxAddress = nullptr;
+    unrollLoopStart = nullptr;
+    unrollLoopEnd = nullptr;
+}
+
+CodeGen::~CodeGen()=default;
+
+// <program>
+std::unique_ptr<llvm::Module> CodeGen::Generate(const ast_program_t *program)
+{
+    std::string name = (program->name != nullptr) ? std::string(program->name, program->length) : "";
+    std::unique_ptr<llvm::Module> module(new llvm::Module(name, llvmContext));
+    llvmModule = module.get();
+
+    // Runtime functions first, then everything declared in the program
+    AddIOFunctions();
+    Declarations(program->decls);
+
+    if (!program->hasBody)
+    {
+        return module;
+    }
+
+    // Need somewhere to put everything, call it main
+    llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+    llvm::FunctionType *type = llvm::FunctionType::get(intType, std::vector<llvm::Type *>(), false);
+    llvm::FunctionCallee mainCallee = llvmModule->getOrInsertFunction("main", type);
+    auto *main = llvm::dyn_cast<llvm::Constant>(mainCallee.getCallee());
+    llvmCurrProc = llvm::cast<llvm::Function>(main);
+
+    // First block is named entry, following llvm kaleidoscope tutorial
+    llvmBuilder.SetInsertPoint(CreateBasicBlock("entry"));
+
+    // the parser ends the body with the return 0
+    Statements(program->body);
+    return module;
+}
+
+// LLVM values of the symbol with this handle
+CodeGen::symbol_ir_t &CodeGen::GetSymbolIR(uint32_t handle)
+{
+    if (handle >= symbols.size())
+    {
+        symbols.resize(handle + 1);
+    }
+    return symbols[handle];
+}
+
+// Declare the runtime functions, see SymbolTable::AddIOFunctions()
+void CodeGen::AddIOFunctions()
+{
+    for (uint32_t handle : symbolTable.GetIOFunctions())
+    {
+        const Symbol &procedure = symbolTable.GetSymbol(handle);
+
+        // OOB_ERROR doesn't return anything
+        bool isOobError = (procedure.GetId() == "OOB_ERROR");
+        llvm::Type *returnType = isOobError ? llvmBuilder.getVoidTy() : GetLLVMType(procedure.GetType());
+
+        llvm::Function *function = llvm::Function::Create(GetFunctionType(procedure, returnType),
+                                                          llvm::Function::ExternalLinkage, procedure.GetId(), llvmModule);
+        GetSymbolIR(handle).function = function;
+
+        if (isOobError)
+        {
+            oobError = function;
+        }
+    }
+}
+
+// Arrays are passed as a pointer to their first element
+llvm::FunctionType *CodeGen::GetFunctionType(const Symbol &procedure, llvm::Type *returnType)
+{
+    std::vector<llvm::Type *> parameters;
+    for (const Symbol &parameter : procedure.GetParameters())
+    {
+        if (parameter.IsArray())
+        {
+            parameters.push_back(GetLLVMType(parameter.GetType())->getPointerTo());
+        }
+        else
+        {
+            parameters.push_back(GetLLVMType(parameter.GetType()));
+        }
+    }
+
+    return llvm::FunctionType::get(returnType, parameters, false);
+}
+
+// All <declaration>
+void CodeGen::Declarations(const ast_decl_t *decl)
+{
+    for (; decl != nullptr; decl = decl->next)
+    {
+        if (decl->kind == AST_PROCEDURE)
+        {
+            Procedure(decl);
+        }
+        else
+        {
+            GlobalVariable(decl);
+        }
+    }
+}
+
+// <variable_declaration> of a global, locals are allocated on entry to their procedure
+void CodeGen::GlobalVariable(const ast_decl_t *decl)
+{
+    const Symbol &variable = symbolTable.GetSymbol(decl->symbol);
+    llvm::Type *globalTy;
+
+    // Global array
+    if (variable.IsArray())
+    {
+        globalTy = llvm::ArrayType::get(GetLLVMType(variable.GetType()), variable.GetArraySize());
+    }
+    else
+    {
+        globalTy = GetLLVMType(variable.GetType());
+    }
+
+    // Create the global variable and initialize it
+    auto *globalVar = new llvm::GlobalVariable(*llvmModule, globalTy, false, llvm::GlobalValue::CommonLinkage,
+                                               llvm::Constant::getNullValue(globalTy), variable.GetId());
+
+    symbol_ir_t &ir = GetSymbolIR(decl->symbol);
+    if (variable.IsArray())
+    {
+        ir.arrayAddress = globalVar;
+        ir.arraySize = CreateConstantInt(32, variable.GetArraySize(), llvmBuilder.getInt32Ty());
+    }
+    else
+    {
+        ir.address = globalVar;
+    }
+}
+
+// <procedure_declaration>
+void CodeGen::Procedure(const ast_decl_t *decl)
+{
+    const Symbol &procedure = symbolTable.GetSymbol(decl->symbol);
+
+    // Create the function for llvm
+    auto *procType = GetFunctionType(procedure, GetLLVMType(procedure.GetType()));
+    auto *proc = llvm::dyn_cast<llvm::Constant>(llvmModule->getOrInsertFunction("function" + std::to_string(decl->index), procType).getCallee());
+    auto *func = llvm::cast<llvm::Function>(proc);
+    GetSymbolIR(decl->symbol).function = func;
+
+    if (!decl->hasBody)
+    {
+        return;
+    }
+
+    // Nested procedures come before this one's body
+    Declarations(decl->decls);
+
+    // Create entry block
+    llvmCurrProc = func;
+    llvmBuilder.SetInsertPoint(CreateBasicBlock("entry"));
+
+    // Create all local variables
+    for (uint32_t i = 0; i < decl->localCount; i++)
+    {
+        const Symbol &variable = symbolTable.GetSymbol(decl->locals[i]);
+        symbol_ir_t &ir = GetSymbolIR(decl->locals[i]);
+
+        // Array
+        if (variable.IsArray())
+        {
+            llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+            ir.arraySize = CreateConstantInt(32, variable.GetArraySize(), intType);
+            ir.arrayAddress = llvmBuilder.CreateAlloca(GetLLVMType(variable.GetType()), ir.arraySize);
+        }
+        else
+        {
+            ir.address = llvmBuilder.CreateAlloca(GetLLVMType(variable.GetType()));
+        }
+    }
+
+    // Store the arguments, arrays are used through the pointer that was passed
+    llvm::Function::arg_iterator args = llvmCurrProc->arg_begin();
+    for (uint32_t i = 0; i < decl->paramCount && args != llvmCurrProc->arg_end(); i++)
+    {
+        llvm::Value *argVal = args++;
+        if (decl->params[i] == SYMBOL_NONE)
+        {
+            continue;
+        }
+
+        const Symbol &parameter = symbolTable.GetSymbol(decl->params[i]);
+        symbol_ir_t &ir = GetSymbolIR(decl->params[i]);
+        if (parameter.IsArray())
+        {
+            ir.arrayAddress = argVal;
+        }
+        else
+        {
+            llvmBuilder.CreateStore(argVal, ir.address);
+        }
+    }
+
+    Statements(decl->body);
+}
+
+// All <statement>
+void CodeGen::Statements(const ast_stmt_t *stmt)
+{
+    for (; stmt != nullptr; stmt = stmt->next)
+    {
+        switch (stmt->kind)
+        {
+            case AST_ASSIGNMENT:
+                AssignmentStatement(stmt);
+                break;
+            case AST_IF:
+                IfStatement(stmt);
+                break;
+            case AST_LOOP:
+                LoopStatement(stmt);
+                break;
+            default:
+                ReturnStatement(stmt);
+                break;
+        }
+    }
+}
+
+// <assignment_statement>
+void CodeGen::AssignmentStatement(const ast_stmt_t *stmt)
+{
+    // Left hand side first, indexing and unrolling generate code
+    llvm::Value *address = Destination(stmt->dest);
+    llvm::Value *value = Expression(stmt->expr);
+
+    // Store expression in the destination
+    llvmBuilder.CreateStore(value, address);
+
+    if (stmt->dest->op == AST_ACCESS_UNROLL)
+    {
+        unrollIdx = llvmBuilder.CreateAdd(unrollIdx, CreateConstantInt(32, 1, llvmBuilder.getInt32Ty()));
+        llvmBuilder.CreateStore(unrollIdx, unrollIdxAddress);
+        llvmBuilder.CreateBr(unrollLoopStart);
+        llvmBuilder.SetInsertPoint(unrollLoopEnd);
+    }
+
+    // A later use of the variable without an index reads from here
+    GetSymbolIR(stmt->dest->symbol).address = address;
+}
+
+// <if_statement>
+void CodeGen::IfStatement(const ast_stmt_t *stmt)
+{
+    llvm::Value *condition = Expression(stmt->expr);
+
+    // Create blocks for "if then" and "else"
+    llvm::BasicBlock *ifBlock = CreateBasicBlock("if");
+    llvm::BasicBlock *elseBlock = CreateBasicBlock("else");
+    llvm::BasicBlock *endBlock = nullptr;
+
+    // Conditional jump that is based on the expression
+    llvmBuilder.CreateCondBr(condition, ifBlock, elseBlock);
+    llvmBuilder.SetInsertPoint(ifBlock);
+
+    // if block statements
+    Statements(stmt->body);
+
+    if (stmt->hasElse)
+    {
+        endBlock = CreateBasicBlock("endIf");
+        if (llvmBuilder.GetInsertBlock()->getTerminator() != nullptr)
+        {
+            llvmBuilder.SetInsertPoint(elseBlock);
+        }
+        else
+        {
+            llvmBuilder.CreateBr(endBlock);
+            llvmBuilder.SetInsertPoint(elseBlock);
+        }
+
+        // else block statements
+        Statements(stmt->elseBody);
+    }
+
+    bool isNullTerm = (llvmBuilder.GetInsertBlock()->getTerminator() == nullptr);
+    if (endBlock != nullptr)
+    {
+        // go from else to end
+        if (isNullTerm)
+        {
+            llvmBuilder.CreateBr(endBlock);
+        }
+
+        llvmBuilder.SetInsertPoint(endBlock);
+    }
+    else
+    {
+        // go from if to else
+        if (isNullTerm)
+        {
+            llvmBuilder.CreateBr(elseBlock);
+        }
+
+        llvmBuilder.SetInsertPoint(elseBlock);
+    }
+}
+
+// <loop_statement>
+void CodeGen::LoopStatement(const ast_stmt_t *stmt)
+{
+    if (stmt->init != nullptr)
+    {
+        AssignmentStatement(stmt->init);
+    }
+
+    llvm::BasicBlock *loopStart = CreateBasicBlock("loopStart");
+    llvm::BasicBlock *loopBody = CreateBasicBlock("loopBody"); // (<statement>;)*
+    llvm::BasicBlock *loopEnd = CreateBasicBlock("loopEnd");
+
+    // jump to start
+    llvmBuilder.CreateBr(loopStart);
+    llvmBuilder.SetInsertPoint(loopStart);
+
+    // Jump to body or end based on expression
+    llvm::Value *condition = Expression(stmt->expr);
+    llvmBuilder.CreateCondBr(condition, loopBody, loopEnd);
+    llvmBuilder.SetInsertPoint(loopBody);
+
+    // Get all statements
+    Statements(stmt->body);
+
+    // Jump to start to check if loop should continue
+    llvmBuilder.CreateBr(loopStart);
+    llvmBuilder.SetInsertPoint(loopEnd);
+}
+
+// <return_statement>
+void CodeGen::ReturnStatement(const ast_stmt_t *stmt)
+{
+    if (stmt->kind == AST_RETURN)
+    {
+        llvmBuilder.CreateRet(Expression(stmt->expr));
+        return;
+    }
+
+    // The program body always returns 0, the expression is still generated (after the return)
+    llvmBuilder.CreateRet(CreateConstantInt(32, 0, llvmBuilder.getInt32Ty()));
+    if (stmt->expr != nullptr)
+    {
+        Expression(stmt->expr);
+    }
+}
+
+// <destination>, returns the address to store to
+llvm::Value *CodeGen::Destination(const ast_expr_t *dest)
+{
+    const Symbol &symbol = symbolTable.GetSymbol(dest->symbol);
+    symbol_ir_t &ir = GetSymbolIR(dest->symbol);
+
+    if (dest->op == AST_ACCESS_INDEX)
+    {
+        return IndexArray(dest);
+    }
+
+    if (dest->op == AST_ACCESS_SCALAR)
+    {
+        return ir.address;
+    }
+
+    // An array with no index, loop over it and assign every element
+    llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+    unrollIdx = CreateConstantInt(32, 0, intType);
+
+    // Store the index
+    unrollIdxAddress = llvmBuilder.CreateAlloca(intType);
+    llvmBuilder.CreateStore(unrollIdx, unrollIdxAddress);
+
+    // Blocks for unrolling loop
+    unrollLoopStart = CreateBasicBlock("unrollLoopStart");
+    llvm::BasicBlock *unrollLoopBody = CreateBasicBlock("unrollLoopBody");
+    unrollLoopEnd = CreateBasicBlock("unrollLoopEnd");
+
+    // Jump to the loop start and load index
+    llvmBuilder.CreateBr(unrollLoopStart);
+    llvmBuilder.SetInsertPoint(unrollLoopStart);
+    unrollIdx = llvmBuilder.CreateLoad(intType, unrollIdxAddress);
+
+    // Check if index equals the size, if it does jump to the end
+    llvm::Value *cmp = llvmBuilder.CreateICmpEQ(unrollIdx, ir.arraySize);
+    llvmBuilder.CreateCondBr(cmp, unrollLoopEnd, unrollLoopBody);
+
+    // Set the insert point to the loop body so that the expression of the assignment statement
+    // goes in the body
+    llvmBuilder.SetInsertPoint(unrollLoopBody);
+    unrollIdx = llvmBuilder.CreateLoad(intType, unrollIdxAddress);
+
+    return UnrolledElement(symbol, ir);
+}
+
+// Bounds checked address of an array element
+llvm::Value *CodeGen::IndexArray(const ast_expr_t *variable)
+{
+    llvm::Value *idx = Expression(variable->lhs);
+
+    const Symbol &array = symbolTable.GetSymbol(variable->symbol);
+    symbol_ir_t &ir = GetSymbolIR(variable->symbol);
+    llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+
+    // Create check for array bounds
+    llvm::Value *lowerBound = llvmBuilder.CreateICmpSLT(idx, ir.arraySize);
+    llvm::Value *upperBound = llvmBuilder.CreateICmpSGE(idx, CreateConstantInt(32, 0, intType));
+    llvm::Value *checkVal = llvmBuilder.CreateAnd(upperBound, lowerBound);
+
+    llvm::BasicBlock *oob = CreateBasicBlock("oob");
+    llvm::BasicBlock *validIdx = CreateBasicBlock("validIdx");
+
+    llvmBuilder.CreateCondBr(checkVal, validIdx, oob);
+    llvmBuilder.SetInsertPoint(oob);
+
+    // for any out of bounds errors
+    // this is treated as a runtime exception as the syntax would still be perfectly valid
+    // and theres no way to tell the size at this point
+    //  i.e. variable x : integer[2]
+    //       x[100] := 1; this syntax is still valid in the eyes of the parser
+    llvmBuilder.CreateCall(oobError);
+    llvmBuilder.CreateBr(validIdx);
+    llvmBuilder.SetInsertPoint(validIdx);
+
+    llvm::Value *arrayAddress = ir.arrayAddress;
+    if (array.IsGlobal())
+    {
+        return llvmBuilder.CreateInBoundsGEP(arrayAddress, {CreateConstantInt(32, 0, intType), idx});
+    }
+    return llvmBuilder.CreateGEP(arrayAddress, idx);
+}
+
+// Address of the element the unrolled assignment is at
+llvm::Value *CodeGen::UnrolledElement(const Symbol &array, const symbol_ir_t &ir)
+{
+    // Can't believe this was the problem after like a month of looking into this...
+    // I was calling GEP on both global and local arrays, when in reality you need to
+    // call CreateInBoundsGEP for globals. This immediately fixed the issues I was
+    // encountering.
+    llvm::Value *arrayAddress = ir.arrayAddress;
+    if (array.IsGlobal())
+    {
+        llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+        return llvmBuilder.CreateInBoundsGEP(arrayAddress, {CreateConstantInt(32, 0, intType), unrollIdx});
+    }
+    return llvmBuilder.CreateGEP(arrayAddress, unrollIdx);
+}
+
+// <expression>, operands are generated before their operator. Same-precedence operators chain to
+// the right (the rhs of a binary is the rest of the chain), so the chain and any unary operators on
+// it are walked in a loop and applied on the way back out, a long one doesn't recurse per operand.
+llvm::Value *CodeGen::Expression(const ast_expr_t *expr)
+{
+    // operator and its already generated left operand (nullptr for unary ones), outermost first
+    std::vector<std::pair<const ast_expr_t *, llvm::Value *> > pending;
+    while (true)
+    {
+        if (expr->kind == AST_BINARY)
+        {
+            pending.emplace_back(expr, Expression(expr->lhs));
+            expr = expr->rhs;
+        }
+        else if (expr->kind == AST_NEGATE || expr->kind == AST_NOT || expr->kind == AST_CONVERT)
+        {
+            pending.emplace_back(expr, nullptr);
+            expr = expr->lhs;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    llvm::Value *value = Operand(expr);
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+    {
+        value = Operator(it->first, it->second, value);
+    }
+    return value;
+}
+
+// Expression without an operator: a literal, variable, call or whole array
+llvm::Value *CodeGen::Operand(const ast_expr_t *expr)
+{
+    switch (expr->kind)
+    {
+        case AST_INT_LITERAL:
+            return CreateConstantInt(32, expr->val.intValue, GetLLVMType(T_INTEGER));
+        case AST_FLOAT_LITERAL:
+            return llvm::ConstantFP::get(GetLLVMType(T_FLOAT), llvm::APFloat(expr->val.floatValue));
+        case AST_BOOL_LITERAL:
+            return CreateConstantInt(1, expr->val.intValue, GetLLVMType(T_BOOL));
+        case AST_STRING_LITERAL:
+            return llvmBuilder.CreateGlobalStringPtr(llvm::StringRef(expr->text, expr->length));
+        case AST_VARIABLE:
+            return Variable(expr);
+        case AST_CALL:
+            return Call(expr);
+        default:
+        {
+            // AST_ARRAY_ARGUMENT, pointer to the first element
+            symbol_ir_t &ir = GetSymbolIR(expr->symbol);
+            if (!symbolTable.GetSymbol(expr->symbol).IsGlobal())
+            {
+                return ir.arrayAddress;
+            }
+
+            llvm::Value *arrayAddress = ir.arrayAddress;
+            llvm::Value *val = llvmBuilder.CreateInBoundsGEP(arrayAddress, CreateConstantInt(32, 0, llvmBuilder.getInt32Ty()));
+            return llvmBuilder.CreateBitCast(val, GetLLVMType(expr->type)->getPointerTo());
+        }
+    }
+}
+
+// Applies expr's operator, value is its (right) operand and lhs the left operand of a binary one
+llvm::Value *CodeGen::Operator(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *value)
+{
+    switch (expr->kind)
+    {
+        case AST_NEGATE:
+            return (expr->type == T_FLOAT) ? llvmBuilder.CreateFNeg(value) : llvmBuilder.CreateNeg(value);
+        case AST_NOT:
+            return llvmBuilder.CreateNot(value);
+        case AST_CONVERT:
+            return Convert(expr, value);
+        default:
+            break;
+    }
+
+    switch (expr->op)
+    {
+        case T_AND:
+        case T_OR:
+            return LogicalOp(expr, lhs, value);
+        case T_ADD:
+        case T_SUBTRACT:
+        case T_MULTIPLY:
+        case T_DIVIDE:
+            return ArithOp(expr, lhs, value);
+        default:
+            return Relation(expr, lhs, value);
+    }
+}
+
+// <name>, loads the variable (or the array element)
+llvm::Value *CodeGen::Variable(const ast_expr_t *expr)
+{
+    llvm::Value *address;
+    switch (expr->op)
+    {
+        case AST_ACCESS_INDEX:
+            address = IndexArray(expr);
+            break;
+        case AST_ACCESS_UNROLL:
+            address = UnrolledElement(symbolTable.GetSymbol(expr->symbol), GetSymbolIR(expr->symbol));
+            break;
+        default:
+            address = GetSymbolIR(expr->symbol).address;
+            break;
+    }
+
+    return llvmBuilder.CreateLoad(GetLLVMType(expr->type), address);
+}
+
+// <procedure_call>
+llvm::Value *CodeGen::Call(const ast_expr_t *expr)
+{
+    std::vector<llvm::Value *> arguments;
+    for (const ast_expr_t *argument = expr->lhs; argument != nullptr; argument = argument->next)
+    {
+        arguments.push_back(Expression(argument));
+    }
+
+    return llvmBuilder.CreateCall(GetSymbolIR(expr->symbol).function, arguments);
+}
+
+// Conversion the parser allowed (with a warning), to expr's type from its operand's
+llvm::Value *CodeGen::Convert(const ast_expr_t *expr, llvm::Value *value)
+{
+    llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+    int from = expr->lhs->type;
+
+    switch (expr->type)
+    {
+        case T_BOOL:
+            // int -> bool
+            return llvmBuilder.CreateICmpNE(value, CreateConstantInt(32, 0, intType));
+        case T_INTEGER:
+            if (from == T_BOOL)
+            {
+                return llvmBuilder.CreateZExtOrTrunc(value, intType);
+            }
+            // float -> int
+            return llvmBuilder.CreateFPToSI(value, intType);
+        default:
+            // int -> float
+            return llvmBuilder.CreateSIToFP(value, llvmBuilder.getFloatTy());
+    }
+}
+
+// & and |, on bools or on ints (bitwise)
+llvm::Value *CodeGen::LogicalOp(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *rhs)
+{
+    if (expr->op == T_AND)
+    {
+        return llvmBuilder.CreateAnd(lhs, rhs);
+    }
+    return llvmBuilder.CreateOr(lhs, rhs);
+}
+
+// + - * /, an int operand is converted when the other one is a float
+llvm::Value *CodeGen::ArithOp(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *rhs)
+{
+    int lhsType = expr->lhs->type;
+    int rhsType = expr->rhs->type;
+
+    if (lhsType == T_INTEGER && rhsType == T_FLOAT)
+    {
+        lhs = llvmBuilder.CreateSIToFP(lhs, llvmBuilder.getFloatTy());
+    }
+    else if (lhsType == T_FLOAT && rhsType == T_INTEGER)
+    {
+        rhs = llvmBuilder.CreateSIToFP(rhs, llvmBuilder.getFloatTy());
+    }
+
+    bool isFloatOp = (lhsType == T_FLOAT || rhsType == T_FLOAT);
+
+    llvm::Instruction::BinaryOps opcode;
+    switch (expr->op)
+    {
+        case T_ADD:
+            opcode = isFloatOp ? llvm::Instruction::FAdd : llvm::Instruction::Add;
+            break;
+        case T_SUBTRACT:
+            opcode = isFloatOp ? llvm::Instruction::FSub : llvm::Instruction::Sub;
+            break;
+        case T_MULTIPLY:
+            opcode = isFloatOp ? llvm::Instruction::FMul : llvm::Instruction::Mul;
+            break;
+        default:
+            opcode = isFloatOp ? llvm::Instruction::FDiv : llvm::Instruction::SDiv;
+            break;
+    }
+
+    llvm::Value *val = llvmBuilder.CreateBinOp(opcode, lhs, rhs);
+
+    // Result type the parser expected. A float result wanted as an int goes through the same
+    // sitofp it always has.
+    if (expr->type == T_FLOAT && !isFloatOp)
+    {
+        val = llvmBuilder.CreateSIToFP(val, llvmBuilder.getFloatTy());
+    }
+    else if (expr->type == T_INTEGER && isFloatOp)
+    {
+        val = llvmBuilder.CreateSIToFP(val, llvmBuilder.getInt32Ty());
+    }
+
+    return val;
+}
+
+// < > <= >= == !=, bools compare as ints and an int compares with a float as a float
+llvm::Value *CodeGen::Relation(const ast_expr_t *expr, llvm::Value *lhs, llvm::Value *rhs)
+{
+    int lhsType = expr->lhs->type;
+    int rhsType = expr->rhs->type;
+    bool isFloatOp = false;
+
+    switch (lhsType)
+    {
+        case T_BOOL:
+            if (rhsType == T_INTEGER)
+            {
+                lhs = llvmBuilder.CreateZExtOrTrunc(lhs, llvmBuilder.getInt32Ty());
+            }
+            break;
+        case T_FLOAT:
+            isFloatOp = true;
+            if (rhsType == T_INTEGER)
+            {
+                rhs = llvmBuilder.CreateSIToFP(rhs, llvmBuilder.getFloatTy());
+            }
+            break;
+        case T_INTEGER:
+            if (rhsType == T_BOOL)
+            {
+                rhs = llvmBuilder.CreateZExtOrTrunc(rhs, llvmBuilder.getInt32Ty());
+            }
+            else if (rhsType == T_FLOAT)
+            {
+                lhs = llvmBuilder.CreateSIToFP(lhs, llvmBuilder.getFloatTy());
+                isFloatOp = true;
+            }
+            break;
+        default:
+            return StringCompare(expr->op, lhs, rhs);
+    }
+
+    switch (expr->op)
+    {
+        case T_LESSTHAN:
+            return isFloatOp ? llvmBuilder.CreateFCmpOLT(lhs, rhs) : llvmBuilder.CreateICmpSLT(lhs, rhs);
+        case T_LTEQ:
+            return isFloatOp ? llvmBuilder.CreateFCmpOLE(lhs, rhs) : llvmBuilder.CreateICmpSLE(lhs, rhs);
+        case T_GREATERTHAN:
+            return isFloatOp ? llvmBuilder.CreateFCmpOGT(lhs, rhs) : llvmBuilder.CreateICmpSGT(lhs, rhs);
+        case T_GTEQ:
+            return isFloatOp ? llvmBuilder.CreateFCmpOGE(lhs, rhs) : llvmBuilder.CreateICmpSGE(lhs, rhs);
+        case T_EQEQ:
+            return isFloatOp ? llvmBuilder.CreateFCmpOEQ(lhs, rhs) : llvmBuilder.CreateICmpEQ(lhs, rhs);
+        default:
+            return isFloatOp ? llvmBuilder.CreateFCmpONE(lhs, rhs) : llvmBuilder.CreateICmpNE(lhs, rhs);
+    }
+}
+
+// == and != on strings, compares a character at a time up to the lhs's '\0'
+llvm::Value *CodeGen::StringCompare(int op, llvm::Value *lhs, llvm::Value *rhs)
+{
+    llvm::IntegerType *intType = llvmBuilder.getInt32Ty();
+
+    // Need to start at -1 because the Add instruction was incrementing the idx before we ever got
+    // to check the first character. This created issues for single character comparisons and the first
+    // character of all strings was actually never being checked, leading to incorrect comparisons.
+    //
+    // ALso i realize i could just move where the add occurs... but this works for now
+    llvm::Value *idxAddr = llvmBuilder.CreateAlloca(intType);
+    llvm::Value *idx = CreateConstantInt(32, -1, intType);
+
+    llvmBuilder.CreateStore(idx, idxAddr);
+
+    llvm::BasicBlock *strCmpStart = CreateBasicBlock("strCmpStart");
+    llvm::BasicBlock *strCmpEnd = CreateBasicBlock("strCmpEnd");
+
+    // jump to the loop start
+    llvmBuilder.CreateBr(strCmpStart);
+    llvmBuilder.SetInsertPoint(strCmpStart);
+
+    idx = llvmBuilder.CreateLoad(intType, idxAddr);
+    idx = llvmBuilder.CreateBinOp(llvm::Instruction::Add, idx, CreateConstantInt(32, 1, intType));
+    llvmBuilder.CreateStore(idx, idxAddr);
+
+    // Get character at 'idx' from each string, you have to create the load with i8 and not i8*
+    // as i found out after 2 weeks of trying to fix string comparison.
+    llvm::IntegerType *int8Ty = llvmBuilder.getInt8Ty();
+    llvm::Value *lhsCharacter = llvmBuilder.CreateLoad(int8Ty, llvmBuilder.CreateGEP(lhs, idx));
+    llvm::Value *rhsCharacter = llvmBuilder.CreateLoad(int8Ty, llvmBuilder.CreateGEP(rhs, idx));
+
+    // compare (==) the first character of lhs and rhs
+    llvm::Value *stringComparison = llvmBuilder.CreateICmpEQ(lhsCharacter, rhsCharacter);
+
+    // escCh = '\0'
+    llvm::Value *escCh = CreateConstantInt(8, 0, int8Ty);
+    llvm::Value *notDone = llvmBuilder.CreateICmpNE(lhsCharacter, escCh);
+
+    // Prev char's match and prev lhsChar was not esc char '\0', then continue
+    llvm::Value *keepGoing = llvmBuilder.CreateAnd(stringComparison, notDone);
+    llvmBuilder.CreateCondBr(keepGoing, strCmpStart, strCmpEnd);
+
+    // end
+    llvmBuilder.SetInsertPoint(strCmpEnd);
+
+    if (op == T_EQEQ)
+    {
+        return stringComparison;
+    }
+    return llvmBuilder.CreateNot(stringComparison);
+}
+
+// Helper function to get the corresponding llvm type from the type
+// returns llvm::Type*
+llvm::Type *CodeGen::GetLLVMType(int type)
+{
+    switch (type)
+    {
+        case T_INTEGER:
+            return llvmBuilder.getInt32Ty();
+        case T_FLOAT:
+            return llvmBuilder.getFloatTy();
+        case T_BOOL:
+            return llvmBuilder.getInt1Ty();
+        case T_STRING:
+            return llvmBuilder.getInt8PtrTy();
+        default:
+            return nullptr;
+    }
+}
+
+// Helper function for easily creating llvm::ConstantInt, as we need a lot of them
+llvm::Value *CodeGen::CreateConstantInt(int numBits, int intVal, llvm::Type *type)
+{
+    llvm::APInt intValue = llvm::APInt(numBits, intVal, true);
+    return llvm::ConstantInt::getIntegerValue(type, intValue);
+}
+
+// Helper function for quickly creating llvm::BasicBlock
+llvm::BasicBlock *CodeGen::CreateBasicBlock(std::string name)
+{
+    return llvm::BasicBlock::Create(llvmContext, name, llvmCurrProc);
+}
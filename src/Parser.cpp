@@ -6,38 +6,59 @@
 
 #include <fstream>
 
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
-Parser::Parser(Scanner scanner_, SymbolTable symbolTable_, token_t *token_)
+// src/runtime.c compiled to bitcode, runtimeBitcode.c is generated from it by the Makefile
+extern "C" const unsigned char runtimeBitcode[];
+extern "C" const unsigned long runtimeBitcodeSize;
+
+// One level of nesting, for as long as it is in scope (see IsNestedTooDeep())
+struct NestingLevel
+{
+    int &depth;
+
+    explicit NestingLevel(int &depth_) : depth(depth_) { depth++; }
+    ~NestingLevel() { depth--; }
+};
+
+Parser::Parser(Scanner scanner_, SymbolTable symbolTable_, token_t *token_, const compile_options_t &options_)
 {
     scanner = scanner_;
     symbolTable = symbolTable_;
     token = token_;
+    symbolTable.SetInterner(scanner.GetInterner());
 
     errorFlag = false;
     doUnroll = false;
     sucessfulResync = false;
+    outputFailed = false;
 
     procedureCount = 0;
     errorCount = 0;
     warningCount = 0;
     unrollSize = 0;
+    nestingDepth = 0;
+    options = options_;
 
-    llvmModule = nullptr;
-    llvmBuilder = nullptr;
-    llvmCurrProc = nullptr;
-    unrollIdx = nullptr;
-    unrollIdxAddress = nullptr;
-    unrollLoopStart = nullptr;
-    unrollLoopEnd = nullptr;
+    program = nullptr;
 
     Program();
 
@@ -68,14 +89,20 @@ Parser::Parser(Scanner scanner_, SymbolTable symbolTable_, token_t *token_)
         std::cout << warningCount << " warnings" << std::endl;
     }
 
+    // --check stops after the diagnostics, LLVM isn't touched and no files are written
+    if (options.checkOnly)
+    {
+        return;
+    }
+
     if ((!errorFlag && errorCount == 0) || sucessfulResync)
     {
-        // Compile
-        std::string outFile = "IR.ll";
-        std::error_code error_code;
-        llvm::raw_fd_ostream out(outFile, error_code, llvm::sys::fs::F_None);
-        llvmModule->print(out, nullptr);
+        // Lower the tree to IR
+        llvmContext = std::make_unique<llvm::LLVMContext>();
+        CodeGen codeGen(symbolTable, *llvmContext);
+        llvmModule = codeGen.Generate(program);
 
+        // Compile
         auto TargetTriple = llvm::sys::getDefaultTargetTriple();
 
         llvm::InitializeAllTargetInfos();
@@ -89,49 +116,327 @@ Parser::Parser(Scanner scanner_, SymbolTable symbolTable_, token_t *token_)
 
         if (!Target)
         {
-            llvm::errs() << Error;
+            llvm::errs() << Error << "\n";
+            outputFailed = true;
             return;
         }
 
-        auto CPU = "generic";
-        auto Features = "";
+        // -march=native is the host's CPU with everything it supports, -mattr goes on top
+        std::string CPU = options.cpu;
+        llvm::SubtargetFeatures targetFeatures;
+        if (CPU == "native")
+        {
+            CPU = llvm::sys::getHostCPUName().str();
+
+            llvm::StringMap<bool> hostFeatures;
+            llvm::sys::getHostCPUFeatures(hostFeatures);
+            for (auto &feature : hostFeatures)
+            {
+                targetFeatures.AddFeature(feature.first(), feature.second);
+            }
+        }
+        llvm::SubtargetFeatures userFeatures(options.features);
+        for (const std::string &feature : userFeatures.getFeatures())
+        {
+            targetFeatures.AddFeature(feature);
+        }
+        std::string Features = targetFeatures.getString();
+
+        std::unique_ptr<llvm::MCSubtargetInfo> subtargetInfo(Target->createMCSubtargetInfo(TargetTriple, "", ""));
+        if (!subtargetInfo->isCPUStringValid(CPU))
+        {
+            llvm::errs() << "Unknown CPU for " << TargetTriple << ": " << CPU << "\n";
+            outputFailed = true;
+            return;
+        }
 
         llvm::TargetOptions opt;
+        // The executable is linked by cc, which builds position independent executables by default
         auto RM = llvm::Optional<llvm::Reloc::Model>();
-        auto TargetMachine = Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
+        if (!options.executable.empty())
+        {
+            RM = llvm::Reloc::PIC_;
+        }
+        const llvm::CodeGenOpt::Level codeGenLevels[] = {
+            llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less, llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive
+        };
+        auto TargetMachine = Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM, llvm::None,
+                                                         codeGenLevels[options.optLevel]);
 
         llvmModule->setDataLayout(TargetMachine->createDataLayout());
         llvmModule->setTargetTriple(TargetTriple);
 
-        auto Filename = "output.o";
+        // The runtime's procedures are compiled for the same target as the program's, below
+        if (options.optLevel > 0 && options.linkRuntime && !LinkRuntime())
+        {
+            outputFailed = true;
+            return;
+        }
+
+        // Record the target on every procedure like clang does, so IR.ll says what it was tuned for
+        if (CPU != "generic" || !Features.empty())
+        {
+            for (llvm::Function &function : *llvmModule)
+            {
+                if (!function.isDeclaration())
+                {
+                    function.addFnAttr("target-cpu", CPU);
+                    if (!Features.empty())
+                    {
+                        function.addFnAttr("target-features", Features);
+                    }
+                }
+            }
+        }
+
+        Optimize(TargetMachine);
+
+        // The optimized IR is only written when it's asked for, as text (--emit=ll) or bitcode (--emit=bc)
+        if (!options.emitLl.empty())
+        {
+            std::error_code EC;
+            llvm::raw_fd_ostream out(options.emitLl, EC, llvm::sys::fs::OF_Text);
+            if (EC)
+            {
+                llvm::errs() << "Could not open file: " << EC.message() << "\n";
+                outputFailed = true;
+                return;
+            }
+            llvmModule->print(out, nullptr);
+        }
+
+        if (!options.emitBc.empty())
+        {
+            std::error_code EC;
+            llvm::raw_fd_ostream out(options.emitBc, EC, llvm::sys::fs::OF_None);
+            if (EC)
+            {
+                llvm::errs() << "Could not open file: " << EC.message() << "\n";
+                outputFailed = true;
+                return;
+            }
+            llvm::WriteBitcodeToFile(*llvmModule, out);
+        }
+
+        // Code generation changes the module it runs on, the assembly comes from a copy when the object
+        // is generated too (the module is only parsed, lowered and optimized once either way)
+        bool needObject = !options.emitObj.empty() || !options.executable.empty();
+        if (!options.emitAsm.empty())
+        {
+            std::error_code EC;
+            llvm::raw_fd_ostream out(options.emitAsm, EC, llvm::sys::fs::OF_Text);
+            if (EC)
+            {
+                llvm::errs() << "Could not open file: " << EC.message() << "\n";
+                outputFailed = true;
+                return;
+            }
+
+            std::unique_ptr<llvm::Module> copy = needObject ? llvm::CloneModule(*llvmModule) : nullptr;
+            if (!EmitCode(TargetMachine, copy ? *copy : *llvmModule, out, llvm::CGFT_AssemblyFile))
+            {
+                outputFailed = true;
+                return;
+            }
+        }
+
+        if (!needObject)
+        {
+            return;
+        }
+
+        // With -o and no --emit=obj the object is only needed until it is linked
+        llvm::SmallString<128> Filename(options.emitObj);
         std::error_code EC;
-        llvm::raw_fd_ostream dest(Filename, EC, llvm::sys::fs::OF_None);
+        int objectFd = -1;
+        if (options.emitObj.empty())
+        {
+            EC = llvm::sys::fs::createTemporaryFile("output", "o", objectFd, Filename);
+        }
+        else
+        {
+            EC = llvm::sys::fs::openFileForWrite(Filename, objectFd);
+        }
 
         if (EC)
         {
-            llvm::errs() << "Could not open file: " << EC.message();
+            llvm::errs() << "Could not open file: " << EC.message() << "\n";
+            outputFailed = true;
             return;
         }
+        llvm::raw_fd_ostream dest(objectFd, true);
 
-        llvm::legacy::PassManager pass;
-        auto FileType = llvm::CGFT_ObjectFile;
-
-        if (TargetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType))
+        if (!EmitCode(TargetMachine, *llvmModule, dest, llvm::CGFT_ObjectFile))
         {
-            llvm::errs() << "TargetMachine can't emit a file of this type";
+            outputFailed = true;
             return;
         }
+        dest.close();
 
-        pass.run(*llvmModule);
-        dest.flush();
+        if (!options.executable.empty())
+        {
+            // code is still generated for a program that had errors if the parser resynced, it isn't linked
+            outputFailed = errorCount > 0 || !LinkExecutable(Filename.str().str());
+            if (options.emitObj.empty())
+            {
+                llvm::sys::fs::remove(Filename);
+            }
+        }
     }
 }
 
 Parser::~Parser()=default;
 
+// Links the runtime (the bitcode of src/runtime.c built into the compiler) into the module, so the
+// optimizer can inline the I/O functions and knows OOB_ERROR doesn't return. The runtime's procedures
+// are made internal, linking output.o with runtime.c as before doesn't define them twice.
+bool Parser::LinkRuntime()
+{
+    llvm::StringRef bitcode(reinterpret_cast<const char*>(runtimeBitcode), runtimeBitcodeSize);
+    auto runtime = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, "runtime.bc"), *llvmContext);
+    if (!runtime)
+    {
+        llvm::errs() << "Could not read the runtime: " << llvm::toString(runtime.takeError()) << "\n";
+        return false;
+    }
+
+    (*runtime)->setDataLayout(llvmModule->getDataLayout());
+    (*runtime)->setTargetTriple(llvmModule->getTargetTriple());
+
+    std::vector<std::string> runtimeFunctions;
+    for (llvm::Function &function : **runtime)
+    {
+        if (!function.isDeclaration())
+        {
+            // Compiled for whatever clang defaulted to, the program's target replaces it
+            function.removeFnAttr("target-cpu");
+            function.removeFnAttr("target-features");
+            function.removeFnAttr("tune-cpu");
+            runtimeFunctions.push_back(function.getName().str());
+        }
+    }
+
+    // Only what the program calls is linked in
+    if (llvm::Linker::linkModules(*llvmModule, std::move(*runtime), llvm::Linker::Flags::LinkOnlyNeeded))
+    {
+        llvm::errs() << "Could not link the runtime\n";
+        return false;
+    }
+
+    for (const std::string &name : runtimeFunctions)
+    {
+        llvm::Function *function = llvmModule->getFunction(name);
+        if (function && !function->isDeclaration())
+        {
+            function->setLinkage(llvm::GlobalValue::InternalLinkage);
+        }
+    }
+
+    return true;
+}
+
+// Runs LLVM's default middle end pipeline for the -O level over the module (promoting the allocas
+// to registers, instcombine, GVN, LICM, inlining and at -O2 and up the loop and SLP vectorizers).
+// -O0 leaves the module as CodeGen generated it.
+void Parser::Optimize(llvm::TargetMachine *targetMachine)
+{
+    if (options.optLevel <= 0)
+    {
+        return;
+    }
+
+#if LLVM_VERSION_MAJOR >= 13
+    typedef llvm::OptimizationLevel OptimizationLevel;
+#else
+    typedef llvm::PassBuilder::OptimizationLevel OptimizationLevel;
+#endif
+    const OptimizationLevel levels[] = {
+        OptimizationLevel::O0, OptimizationLevel::O1, OptimizationLevel::O2, OptimizationLevel::O3
+    };
+
+    // Vectorize at the same levels clang does
+    llvm::PipelineTuningOptions tuning;
+    tuning.LoopVectorization = (options.optLevel >= 2);
+    tuning.SLPVectorization = (options.optLevel >= 2);
+
+    llvm::LoopAnalysisManager loopAnalysis;
+    llvm::FunctionAnalysisManager functionAnalysis;
+    llvm::CGSCCAnalysisManager cgsccAnalysis;
+    llvm::ModuleAnalysisManager moduleAnalysis;
+
+    llvm::PassBuilder passBuilder(targetMachine, tuning);
+    passBuilder.registerModuleAnalyses(moduleAnalysis);
+    passBuilder.registerCGSCCAnalyses(cgsccAnalysis);
+    passBuilder.registerFunctionAnalyses(functionAnalysis);
+    passBuilder.registerLoopAnalyses(loopAnalysis);
+    passBuilder.crossRegisterProxies(loopAnalysis, functionAnalysis, cgsccAnalysis, moduleAnalysis);
+
+    llvm::ModulePassManager passes = passBuilder.buildPerModuleDefaultPipeline(levels[options.optLevel]);
+    passes.run(*llvmModule, moduleAnalysis);
+}
+
+// Runs the backend over module, writing an object or assembly file to dest
+bool Parser::EmitCode(llvm::TargetMachine *targetMachine, llvm::Module &module, llvm::raw_pwrite_stream &dest,
+                      llvm::CodeGenFileType fileType)
+{
+    llvm::legacy::PassManager pass;
+    if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType))
+    {
+        llvm::errs() << "TargetMachine can't emit a file of this type\n";
+        return false;
+    }
+
+    pass.run(module);
+    return true;
+}
+
+// Links the object with the prebuilt runtime (libruntime.a, built next to the compiler) into the -o
+// executable. It runs the system's cc to link, lld can't be called in-process because it isn't part
+// of the LLVM libraries the compiler is built with. The runtime isn't compiled again like it is with
+// `clang output.o src/runtime.c -lm`.
+bool Parser::LinkExecutable(const std::string &objectFile)
+{
+    if (!llvm::sys::fs::exists(options.runtimeArchive))
+    {
+        llvm::errs() << "Could not find the runtime " << options.runtimeArchive << ", run make\n";
+        return false;
+    }
+
+    auto linker = llvm::sys::findProgramByName("cc");
+    if (!linker)
+    {
+        llvm::errs() << "Could not find cc to link " << options.executable << "\n";
+        return false;
+    }
+
+    llvm::StringRef args[] = {
+        *linker, objectFile, options.runtimeArchive, "-lm", "-o", options.executable
+    };
+    std::string message;
+    int status = llvm::sys::ExecuteAndWait(*linker, args, llvm::None, {}, 0, 0, &message);
+    if (status != 0)
+    {
+        llvm::errs() << "Could not link " << options.executable << (message.empty() ? "" : ": ") << message << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+int Parser::GetErrorCount()
+{
+    return errorCount;
+}
+
+bool Parser::OutputFailed()
+{
+    return outputFailed;
+}
+
 // <program>
 void Parser::Program()
 {
+    program = ast.New<ast_program_t>();
     symbolTable.AddScope();
     ProgramHeader();
     ProgramBody();
@@ -148,7 +453,7 @@ void Parser::ProgramHeader()
     }
 
     // name of the program
-    std::string id = Identifier();
+    uint32_t id = Identifier();
 
     // "is" keyword not found
     if (!ValidateToken(T_IS))
@@ -157,19 +462,20 @@ void Parser::ProgramHeader()
         return;
     }
 
-    // Create module and builder now that they are needed, and add runtime functions
-    llvmModule = new llvm::Module(id, llvmContext);
-    llvmBuilder = new llvm::IRBuilder<>(llvmContext);
+    // The module is named after the program
+    const std::string &name = scanner.GetInterner()->GetName(id);
+    program->name = ast.CopyString(name.data(), name.size());
+    program->length = name.size();
 
     // Add built in functions to the symbol table
-    symbolTable.AddIOFunctions(llvmModule, llvmBuilder);
+    symbolTable.AddIOFunctions();
 }
 
 // <program_body>
 void Parser::ProgramBody()
 {
     // Get all declarations
-    Declarations();
+    program->decls = Declarations();
 
     // Don't call ValidateToken(), because Declarations() has already gotten the next token
     if (token->type != T_BEGIN)
@@ -178,18 +484,11 @@ void Parser::ProgramBody()
         return;
     }
 
-    // Need somewhere to put everything, call it main
-    llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-    llvm::FunctionType *type = llvm::FunctionType::get(intType, std::vector<llvm::Type *>(), false);
-    llvm::FunctionCallee mainCallee = llvmModule->getOrInsertFunction("main", type);
-    auto *main = llvm::dyn_cast<llvm::Constant>(mainCallee.getCallee());
-    llvmCurrProc = llvm::cast<llvm::Function>(main);
-
-    // First block is named entry, following llvm kaleidoscope tutorial
-    llvmBuilder->SetInsertPoint(CreateBasicBlock("entry"));
+    // The statements go in main
+    program->hasBody = true;
 
     // Get all statements
-    Statements(true);
+    program->body = Statements(true);
 
     // Don't call ValidateToken(), because Statements() has already gotten the next token
     if (token->type != T_END)
@@ -211,22 +510,22 @@ void Parser::ProgramBody()
 
     // Always return an integer (0), because according to the way the language is defined, you can have a return
     // statement in the program body but we don't really want to do anything with it.
-    llvmBuilder->CreateRet(CreateConstantInt(32, 0, intType));
+    ast_stmt_t **tail = &program->body;
+    while (*tail != nullptr)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = ast.New<ast_stmt_t>();
+    (*tail)->kind = AST_PROGRAM_RETURN;
 }
 
 // This function handles checking token type matches the expected type
-// and does not actually advance the file pointer if it doesn't. Also handles
-// eating whitespace/comments. This should be called in 99% of situations rather than
+// and does not actually advance the file pointer if it doesn't. The scanner already
+// skips whitespace/comments. This should be called in 99% of situations rather than
 // directly calling scanner.GetToken()/PeekToken() as it is safer.
 bool Parser::ValidateToken(int tokenType)
 {
-    // Ignore comments
     token_t* tempToken = scanner.PeekToken();
-    while (tempToken->type == T_COMMENT)
-    {
-        token = scanner.GetToken();
-        tempToken = scanner.PeekToken();
-    }
 
     if (tempToken->type == tokenType)
     {
@@ -235,7 +534,16 @@ bool Parser::ValidateToken(int tokenType)
     }
     else if (tempToken->type == T_UNKNOWN)
     {
-        ReportError("Unknown token was found");
+        // the scanner turns numbers that don't fit into unknown tokens
+        llvm::StringRef text = scanner.GetTokenText(tempToken);
+        if (!text.empty() && text[0] >= '0' && text[0] <= '9')
+        {
+            ReportError("Number literal out of range: " + text.str(), tempToken);
+        }
+        else
+        {
+            ReportError("Unknown token was found", tempToken);
+        }
         return false;
     }
     else if (tempToken->type == T_EOF)
@@ -265,11 +573,13 @@ std::string Parser::TypeToString(int tokenType)
 }
 
 // General error reporting function
-void Parser::ReportError(std::string msg)
+void Parser::ReportError(std::string msg, token_t *at)
 {
     if (errorFlag) return;
 
-    printf("\nLine: %d Col: %d\n\t", token->line, token->col);
+    int line, col;
+    scanner.GetTokenLocation(at != nullptr ? at : token, line, col);
+    printf("\nLine: %d Col: %d\n\t", line, col);
     std::cout << msg << std::endl;
     errorFlag = true;
     errorCount++;
@@ -280,7 +590,9 @@ void Parser::ReportMissingTokenError(std::string expected)
 {
     if (errorFlag) return;
 
-    printf("\nLine: %d Col: %d \n\tExpected token ", token->line, token->col);
+    int line, col;
+    scanner.GetTokenLocation(token, line, col);
+    printf("\nLine: %d Col: %d \n\tExpected token ", line, col);
     std::cout << expected << std::endl;
     errorFlag = true;
     errorCount++;
@@ -291,7 +603,9 @@ void Parser::ReportIncompatibleTypeError(std::string op, std::string type1, std:
 {
     if (errorFlag) return;
 
-    printf("\nLine: %d Col: %d\n\t", token->line, token->col);
+    int line, col;
+    scanner.GetTokenLocation(token, line, col);
+    printf("\nLine: %d Col: %d\n\t", line, col);
     std::cout << "The following types are not compatible for " << op << " operations\n\n\t\t";
     std::cout << type1 << " and " << type2 << std :: endl;
     errorFlag = true;
@@ -301,36 +615,53 @@ void Parser::ReportIncompatibleTypeError(std::string op, std::string type1, std:
 // Used for reporting warnings (parse/compile can still continue if there are warnings)
 void Parser::ReportWarning(std::string msg)
 {
-    printf("\nLine: %d Col: %d\n\t", token->line, token->col);
+    int line, col;
+    scanner.GetTokenLocation(token, line, col);
+    printf("\nLine: %d Col: %d\n\t", line, col);
     std::cout << "Warning: " << msg << std::endl;
     warningCount++;
 }
 
 // <identifier>
-std::string Parser::Identifier()
+uint32_t Parser::Identifier()
 {
     if (ValidateToken(T_IDENTIFIER))
     {
-        return token->val.stringValue;
+        return token->val.atom;
     }
 
     ReportError("Identifier expected");
-    return std::string();
+    return ATOM_NONE;
 }
 
 // Get all <declaration> and stop when the terminating token(s) are reached
-void Parser::Declarations()
+ast_decl_t *Parser::Declarations()
 {
+    if (IsNestedTooDeep())
+    {
+        return nullptr;
+    }
+    NestingLevel level(nestingDepth);
+
+    ast_decl_t *decls = nullptr;
+    ast_decl_t **tail = &decls;
+
     // No declarations
     if (ValidateToken(T_BEGIN))
     {
-        return;
+        return decls;
     }
 
     bool continue_ = true;
     while (continue_)
     {
-        Declaration();
+        // kept even if it has an error, a global or a procedure is generated as soon as its name is known
+        ast_decl_t *decl = Declaration();
+        if (decl != nullptr)
+        {
+            *tail = decl;
+            tail = &decl->next;
+        }
 
         if (errorFlag)
         {
@@ -339,20 +670,19 @@ void Parser::Declarations()
             //       consider that we are basically just ignoring a valid error but we are able to obtain resynchronization,
             //       for test1.src and test1b.src
 //            std::cout << token->type << std::endl;
-            if (DoResync(true))
+            // the declarations after it are parsed on in this loop, not a nested Declarations() that
+            // would count towards --max-depth for every declaration with an error
+            if (!DoResync(true))
             {
-                Declarations();
-                return;
+                return decls;
             }
-
-            return;
         }
         else
         {
             if (!ValidateToken(T_SEMICOLON))
             {
                 ReportMissingTokenError(";");
-                return;
+                return decls;
             }
         }
 
@@ -363,10 +693,12 @@ void Parser::Declarations()
             continue_ = false;
         }
     }
+
+    return decls;
 }
 
 // <declaration>
-void Parser::Declaration()
+ast_decl_t *Parser::Declaration()
 {
     Symbol symbol;
     if (ValidateToken(T_GLOBAL) || symbolTable.GetScopeCount() == 0) // testing to make all declarations in outermost scope global
@@ -374,16 +706,16 @@ void Parser::Declaration()
         symbol.SetIsGlobal(true);
         if (ValidateToken(T_PROCEDURE))
         {
-            ProcedureDeclaration(symbol);
+            return ProcedureDeclaration(symbol);
         }
         else if (ValidateToken(T_VARIABLE))
         {
-            VariableDeclaration(symbol);
+            return VariableDeclaration(symbol);
         }
         else
         {
             ReportError("Error parsing declaration, expected a procedure or variable");
-            return;
+            return nullptr;
         }
     }
     else
@@ -391,28 +723,29 @@ void Parser::Declaration()
         symbol.SetIsGlobal(false); // Just to be safe, should already be set to false
         if (ValidateToken(T_PROCEDURE))
         {
-            ProcedureDeclaration(symbol);
+            return ProcedureDeclaration(symbol);
         }
         else if (ValidateToken(T_VARIABLE))
         {
-            VariableDeclaration(symbol);
+            return VariableDeclaration(symbol);
         }
         else
         {
             ReportError("Error parsing declaration, expected a procedure or variable");
-            return;
+            return nullptr;
         }
     }
 
 }
 
 // <variable_declaration>
-void Parser::VariableDeclaration(Symbol &variable)
+ast_decl_t *Parser::VariableDeclaration(Symbol &variable)
 {
     variable.SetDeclarationType(T_VARIABLE);
 
-    std::string id = Identifier();
-    variable.SetId(id);
+    uint32_t id = Identifier();
+    variable.SetId(scanner.GetInterner()->GetName(id));
+    variable.SetAtom(id);
 
     if (!ValidateToken(T_COLON))
     {
@@ -430,124 +763,97 @@ void Parser::VariableDeclaration(Symbol &variable)
         if (!ValidateToken(T_RBRACKET))
         {
             ReportMissingTokenError("]");
-            return;
+            return nullptr;
         }
     }
 
+    // Globals are zero initialized. They are generated even if the name is a duplicate (LLVM
+    // renames it), locals are allocated by their procedure.
+    ast_decl_t *decl = nullptr;
     if (variable.IsGlobal())
     {
-        llvm::Type *globalTy;
-
-        // Global array
-        if (variable.IsArray())
-        {
-            globalTy = llvm::ArrayType::get(GetLLVMType(variable), variable.GetArraySize());
-        }
-        else
-        {
-            globalTy = GetLLVMType(variable);
-        }
-
-        // Create the global variable and initialize it
-        auto *globalVar = new llvm::GlobalVariable(*llvmModule, globalTy, false,
-                                                                   llvm::GlobalValue::CommonLinkage,
-                                                                   llvm::Constant::getNullValue(globalTy), variable.GetId());
         variable.SetIsInitialized(true);
 
-        // Array
-        if (variable.IsArray())
+        if (variable.GetType() != T_UNKNOWN)
         {
-            variable.SetArrayAddress(globalVar);
-            llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-            variable.SetLLVMArraySize(CreateConstantInt(32, variable.GetArraySize(), intType));
-        }
-        else
-        {
-            variable.SetAddress(globalVar);
+            decl = ast.New<ast_decl_t>();
+            decl->kind = AST_GLOBAL_VARIABLE;
+            decl->symbol = symbolTable.NewSymbol(variable);
         }
     }
 
     // Make sure we don't add duplicate identifiers
-    Symbol globalDuplicate = symbolTable.FindSymbol(variable.GetId());
-    if (variable.IsGlobal() && globalDuplicate.IsValid())
+    bool globalDuplicate = symbolTable.GetSymbol(symbolTable.FindSymbol(variable.GetAtom())).IsValid();
+    if (variable.IsGlobal() && globalDuplicate)
     {
         ReportError("Identifier already exists");
-        return;
+        return decl;
     }
 
-    if (symbolTable.DoesSymbolExist(variable.GetId()))
+    if (symbolTable.DoesSymbolExist(variable.GetAtom()))
     {
         ReportError("Identifier already exists");
-        return;
+        return decl;
     }
 
     // All good, we can now add the symbol to the symbol table
-    symbolTable.AddSymbol(variable);
+    if (decl != nullptr)
+    {
+        symbolTable.AddSymbol(decl->symbol);
+    }
+    else
+    {
+        symbolTable.AddSymbol(variable);
+    }
+    return decl;
 }
 
 // <procedure_declaration>
-void Parser::ProcedureDeclaration(Symbol &procedure)
+ast_decl_t *Parser::ProcedureDeclaration(Symbol &procedure)
 {
     // Add a new scope for the current procedure
     symbolTable.AddScope();
     procedure.SetDeclarationType(T_PROCEDURE);
     ProcedureHeader(procedure);
 
-    // Get the parameters (if any)
-    std::vector<llvm::Type *> parameters;
-    for (const Symbol& parameter : procedure.GetParameters())
-    {
-        if (parameter.IsArray())
-        {
-            llvm::PointerType *parameterPtr = GetLLVMType(parameter)->getPointerTo();
-            parameters.push_back(parameterPtr);
-        }
-        else
-        {
-            llvm::Type *type = GetLLVMType(parameter);
-            parameters.push_back(type);
-        }
-    }
-
-    // Create the function for llvm
-    auto *procType = llvm::FunctionType::get(GetLLVMType(procedure), parameters, false);
-    auto *proc = llvm::dyn_cast<llvm::Constant>(llvmModule->getOrInsertFunction("function" + std::to_string(procedureCount), procType).getCallee());
-    procedureCount++;
-
-    auto *func = llvm::cast<llvm::Function>(proc);
-    procedure.SetFunction(func);
+    // The function is generated (and numbered) even if the name turns out to be taken
+    ast_decl_t *decl = ast.New<ast_decl_t>();
+    decl->kind = AST_PROCEDURE;
+    decl->index = procedureCount++;
+    decl->symbol = symbolTable.NewSymbol(procedure);
 
     // Don't add if it already exists
-    std::string checkID = procedure.GetId();
-    if (symbolTable.DoesSymbolExist(checkID))
+    if (symbolTable.DoesSymbolExist(procedure.GetAtom()))
     {
         ReportError("This identifier already exists");
-        return;
+        return decl;
     }
 
     // We need to add the symbol to this procedures scope, as it needs to be able to call itself for recursive calls
-    symbolTable.AddSymbol(procedure);
-    symbolTable.SetScopeProc(procedure);
+    symbolTable.AddSymbol(decl->symbol);
+    symbolTable.SetScopeProc(decl->symbol);
 
-    ProcedureBody();
+    ProcedureBody(decl);
 
     symbolTable.RemoveScope();
 
     // Check that the procedure has not already been defined in the upper scope before adding it
-    if (symbolTable.GetScopeCount() != 0 && symbolTable.DoesSymbolExist(procedure.GetId()))
+    if (symbolTable.GetScopeCount() != 0 && symbolTable.DoesSymbolExist(procedure.GetAtom()))
     {
         ReportError("This identifier already exists");
-        return;
+        return decl;
     }
 
-    symbolTable.AddSymbol(procedure);
+    symbolTable.AddSymbol(decl->symbol);
+    return decl;
 }
 
 // <procedure_header>
 void Parser::ProcedureHeader(Symbol &procedure)
 {
-    std::string id = Identifier(); // Get procedure name
-    procedure.SetId(id);
+    uint32_t id = Identifier(); // Get procedure name
+    procedure.SetId(scanner.GetInterner()->GetName(id));
+    procedure.SetAtom(id);
 
     if (!ValidateToken(T_COLON))
     {
@@ -597,10 +903,11 @@ void Parser::Parameter(Symbol &procedure)
 }
 
 // <argument_list>
-std::vector<llvm::Value *> Parser::ArgumentList(std::vector<Symbol> &arguments_)
+ast_expr_t *Parser::ArgumentList(std::vector<Symbol> &arguments_)
 {
     bool continue_ = true;
-    std::vector<llvm::Value *> arguments;
+    ast_expr_t *arguments = nullptr;
+    ast_expr_t **tail = &arguments;
     std::vector<Symbol>::iterator curr = arguments_.begin();
     std::vector<Symbol>::iterator end = arguments_.end();
 
@@ -616,43 +923,43 @@ std::vector<llvm::Value *> Parser::ArgumentList(std::vector<Symbol> &arguments_)
         }
 
         // Make sure the type matches what is expected
-        Symbol expr = Symbol();
-        Expression(*curr, expr);
-        ValidateAssignment(*curr, expr);
+        expr_t expr;
+        Expression(curr->GetType(), expr);
+        ValidateAssignment(curr->GetType(), expr);
+
+        // the variable passed, if it was one
+        const Symbol &argument = symbolTable.GetSymbol(expr.symbol);
 
         if (curr->IsArray())
         {
-            if (curr->GetArraySize() != expr.GetArraySize() || expr.IsArrayIndexed())
+            if (curr->GetArraySize() != argument.GetArraySize() || expr.isIndexed)
             {
                 ReportError("Array expected as argument");
                 return arguments;
             }
         }
-        else if (expr.IsArray() && !expr.IsArrayIndexed())
+        else if (argument.IsArray() && !expr.isIndexed)
         {
             ReportError("Invalid argument: Cannot pass un-indexed array");
             return arguments;
         }
 
-        if (!expr.IsValid())
+        if (!expr.isValid)
         {
             return arguments;
         }
 
-        // add to arg vector
-        bool addArrayArg = (expr.IsArray() && !expr.IsArrayIndexed() && expr.IsGlobal());
+        // add to arg list, a whole array is passed as a pointer to its first element
+        bool addArrayArg = (argument.IsArray() && !expr.isIndexed);
         if (addArrayArg)
         {
-            llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-            llvm::Value *val = llvmBuilder->CreateInBoundsGEP(expr.GetArrayAddress(), CreateConstantInt(32, 0, intType));
-            val = llvmBuilder->CreateBitCast(val, GetLLVMType(expr)->getPointerTo());
-            arguments.push_back(val);
-        }
-        else
-        {
-            arguments.push_back(expr.GetValue());
+            expr.node = NewExpr(AST_ARRAY_ARGUMENT, expr.type);
+            expr.node->symbol = expr.symbol;
         }
 
+        *tail = expr.node;
+        tail = &expr.node->next;
+
         // but wait, there's more
         if (ValidateToken(T_COMMA))
         {
@@ -679,70 +986,48 @@ std::vector<llvm::Value *> Parser::ArgumentList(std::vector<Symbol> &arguments_)
 }
 
 // <procedure_body>
-void Parser::ProcedureBody()
+void Parser::ProcedureBody(ast_decl_t *decl)
 {
-    // Get all declarations
-    Declarations();
+    decl->hasBody = true;
 
-    // Get the scopes procedure and set the current procedure to it
-    Symbol currProc = symbolTable.GetScopeProc();
+    // Get all declarations
+    decl->decls = Declarations();
 
-    // Create entry block
-    llvmCurrProc = currProc.GetFunction();
-    llvmBuilder->SetInsertPoint(CreateBasicBlock("entry"));
+    // Get the scopes procedure
+    Symbol &currProc = symbolTable.GetSymbol(symbolTable.GetScopeProc());
 
-    // Create all local variables
-    std::map<std::string, Symbol>::iterator it;
-    for (auto &it : symbolTable.GetLocalScope())
+    // All local variables, allocated on entry in the order they were declared
+    llvm::ArrayRef<scope_entry_t> scope = symbolTable.GetLocalScope();
+    uint32_t *locals = ast.NewHandles(scope.size());
+    decl->locals = locals;
+    for (const scope_entry_t &entry : scope)
     {
-        if (it.second.GetDeclarationType() != T_VARIABLE) {
+        Symbol &variable = symbolTable.GetSymbol(entry.handle);
+        if (variable.GetDeclarationType() != T_VARIABLE) {
             continue;
         }
 
-        // Array
-        if (it.second.IsArray())
-        {
-            llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-            llvm::Value *size = CreateConstantInt(32, it.second.GetArraySize(), intType);
-            it.second.SetLLVMArraySize(size);
-
-            it.second.SetArrayAddress(llvmBuilder->CreateAlloca(GetLLVMType(it.second), size));
-            it.second.SetIsInitialized(true);
-        }
-        else
+        // Arrays have their storage from the start
+        if (variable.IsArray())
         {
-            it.second.SetAddress(llvmBuilder->CreateAlloca(GetLLVMType(it.second)));
+            variable.SetIsInitialized(true);
         }
-
-        symbolTable.AddSymbol(it.second);
+        locals[decl->localCount++] = entry.handle;
     }
 
-    // Create arguments
-    llvm::Function::arg_iterator args = llvmCurrProc->arg_begin();
-    for (const Symbol& sym : currProc.GetParameters())
+    // Parameters get the arguments' values
+    std::vector<Symbol> &parameters = currProc.GetParameters();
+    uint32_t *params = ast.NewHandles(parameters.size());
+    decl->params = params;
+    decl->paramCount = parameters.size();
+    for (size_t i = 0; i < parameters.size(); i++)
     {
-        if (args == llvmCurrProc->arg_end())
-        {
-            ReportError("Could not generator LLVM IR for args");
-            return;
-        }
-
-        // Create arg value and update
-        llvm::Value *argVal = args++;
-
-        Symbol newSymbol = symbolTable.FindSymbol(sym.GetId());
-        if (newSymbol.IsArray())
-        {
-            newSymbol.SetArrayAddress(argVal);
-        }
-        else
+        // SYMBOL_NONE if the parameter's declaration failed, already reported
+        params[i] = symbolTable.FindSymbol(parameters[i].GetAtom());
+        if (params[i] != SYMBOL_NONE)
         {
-            llvmBuilder->CreateStore(argVal, newSymbol.GetAddress());
+            symbolTable.GetSymbol(params[i]).SetIsInitialized(true);
         }
-
-        newSymbol.SetValue(argVal);
-        newSymbol.SetIsInitialized(true);
-        symbolTable.AddSymbol(newSymbol);
     }
 
     if (token->type != T_BEGIN)
@@ -752,7 +1037,7 @@ void Parser::ProcedureBody()
     }
 
     // Get all statements
-    Statements(true);
+    decl->body = Statements(true);
 
     if (!ValidateToken(T_PROCEDURE))
     {
@@ -760,9 +1045,16 @@ void Parser::ProcedureBody()
         return;
     }
 
-    if (llvmBuilder->GetInsertBlock()->getTerminator() == nullptr)
+    // Force procedures to have returns, the last statement has to be one (a return inside an if
+    // or a loop still falls through to the end)
+    ast_stmt_t *last = decl->body;
+    while (last != nullptr && last->next != nullptr)
+    {
+        last = last->next;
+    }
+
+    if (last == nullptr || last->kind != AST_RETURN)
     {
-        // Force procedures to have returns
         ReportError("Procedure is required to have a return value.");
         return;
     }
@@ -808,7 +1100,7 @@ void Parser::Bound(Symbol &symbol)
         return;
     }
 
-    Symbol bound = Symbol();
+    expr_t bound;
     Number(bound);
 
     int size = token->val.intValue;
@@ -816,8 +1108,17 @@ void Parser::Bound(Symbol &symbol)
 }
 
 // Get all <statement>
-void Parser::Statements(bool singleTerminator)
+ast_stmt_t *Parser::Statements(bool singleTerminator)
 {
+    if (IsNestedTooDeep())
+    {
+        return nullptr;
+    }
+    NestingLevel level(nestingDepth);
+
+    ast_stmt_t *stmts = nullptr;
+    ast_stmt_t **tail = &stmts;
+
     bool continue_ = true;
     int numTerms = (singleTerminator ? 1 : 2);
     std::vector<int> terminators;
@@ -844,26 +1145,31 @@ void Parser::Statements(bool singleTerminator)
     // Parse statements
     while (continue_)
     {
-        Statement();
+        ast_stmt_t *stmt = Statement();
 
         if (errorFlag)
         {
             // TODO: RE: resync i don't get the point of this, but we are able to obtain resynchronization,
             //       for test1.src and test1b.src
-            if (DoResync(false))
+            // the statements after it are parsed on in this loop, not a nested Statements() that
+            // would count towards --max-depth for every statement with an error
+            if (!DoResync(false))
             {
-                Statements(singleTerminator);
-                return;
+                return stmts;
             }
-
-            return;
         }
         else
         {
+            if (stmt != nullptr)
+            {
+                *tail = stmt;
+                tail = &stmt->next;
+            }
+
             if (!ValidateToken(T_SEMICOLON))
             {
                 ReportMissingTokenError(";");
-                return;
+                return stmts;
             }
         }
 
@@ -877,70 +1183,65 @@ void Parser::Statements(bool singleTerminator)
             }
         }
     }
+
+    return stmts;
 }
 
 // <statement>
-void Parser::Statement()
+ast_stmt_t *Parser::Statement()
 {
     token = scanner.PeekToken();
     switch (token->type)
     {
         case T_IDENTIFIER:
-            AssignmentStatement();
-            break;
+            return AssignmentStatement();
         case T_IF:
-            IfStatement();
-            break;
+            return IfStatement();
         case T_FOR:
-            LoopStatement();
-            break;
+            return LoopStatement();
         case T_RETURN:
-            ReturnStatement();
-            break;
+            return ReturnStatement();
         default:
             ReportError("Expected if, for, or return statement.");
-            break;
+            return nullptr;
     }
-
-    return;
 }
 
 // <assignment_statement>
-void Parser::AssignmentStatement()
+ast_stmt_t *Parser::AssignmentStatement()
 {
     // Left hand side
-    Symbol dest = Destination();
+    expr_t dest = Destination();
     if (!ValidateToken(T_ASSIGNMENT))
     {
         ReportMissingTokenError(":=");
     }
 
     // Right hand side
-    Symbol expr = Symbol();
-    Expression(dest, expr);
-    ValidateAssignment(dest, expr);
+    expr_t expr;
+    Expression(dest.type, expr);
+    ValidateAssignment(dest.type, expr);
 
-    if (!expr.IsValid()) { return; }
+    // (no node if the destination wasn't found, that error is already reported)
+    if (!expr.isValid || dest.node == nullptr) { return nullptr; }
 
     // Store expression in the destination
-    llvmBuilder->CreateStore(expr.GetValue(), dest.GetAddress());
-    dest.SetValue(expr.GetValue());
-
-    if (doUnroll)
-    {
-        unrollIdx = llvmBuilder->CreateAdd(unrollIdx, CreateConstantInt(32, 1, llvmBuilder->getInt32Ty()));
-        llvmBuilder->CreateStore(unrollIdx, unrollIdxAddress);
-        llvmBuilder->CreateBr(unrollLoopStart);
-        llvmBuilder->SetInsertPoint(unrollLoopEnd);
-        doUnroll = false;
-    }
+    ast_stmt_t *stmt = ast.New<ast_stmt_t>();
+    stmt->kind = AST_ASSIGNMENT;
+    stmt->dest = dest.node;
+    stmt->expr = expr.node;
+    doUnroll = false;
 
-    dest.SetIsInitialized(true);
-    symbolTable.AddSymbol(dest); // Update
+    // Update
+    Symbol &symbol = symbolTable.GetSymbol(dest.symbol);
+    symbol.SetIsValid(dest.isValid);
+    symbol.SetIsArrayIndexed(dest.isIndexed);
+    symbol.SetIsInitialized(true);
+    return stmt;
 }
 
 // <if_statement>
-void Parser::IfStatement()
+ast_stmt_t *Parser::IfStatement()
 {
     if (!ValidateToken(T_IF))
     {
@@ -950,193 +1251,140 @@ void Parser::IfStatement()
     if (!ValidateToken(T_LPAREN))
     {
         ReportMissingTokenError("(");
-        return;
+        return nullptr;
     }
 
     // Get expression
-    Symbol expected = Symbol();
-    expected.SetType(T_BOOL);
-    Symbol expr = Symbol();
-    Expression(expected, expr);
+    expr_t expr;
+    Expression(T_BOOL, expr);
 
     // Do type conversion on compatible types
-    if (expr.GetType() == T_INTEGER)
+    if (expr.type == T_INTEGER)
     {
         ReportWarning("Converting integer to boolean");
-        llvm::Value *val = llvmBuilder->CreateICmpNE(expr.GetValue(), CreateConstantInt(32, 0, llvmBuilder->getInt32Ty()));
-        expr.SetValue(val);
+        expr.node = NewExpr(AST_CONVERT, T_BOOL, expr.node);
     }
-    else if (expr.GetType() != T_BOOL)
+    else if (expr.type != T_BOOL)
     {
         ReportError("If statement must evaluate to bool (or int)");
-        return;
+        return nullptr;
     }
 
     if (!ValidateToken(T_RPAREN))
     {
         ReportMissingTokenError(")");
-        return;
+        return nullptr;
     }
 
     if (!ValidateToken(T_THEN))
     {
         ReportMissingTokenError("THEN");
-        return;
+        return nullptr;
     }
 
-    // Create blocks for "if then" and "else"
-    llvm::BasicBlock *ifBlock = CreateBasicBlock("if");
-    llvm::BasicBlock *elseBlock = CreateBasicBlock("else");
-    llvm::BasicBlock *endBlock = nullptr;
-
-    // Conditional jump that is based on the expression
-    llvmBuilder->CreateCondBr(expr.GetValue(), ifBlock, elseBlock);
-    llvmBuilder->SetInsertPoint(ifBlock);
+    ast_stmt_t *stmt = ast.New<ast_stmt_t>();
+    stmt->kind = AST_IF;
+    stmt->expr = expr.node;
 
     // if block statements
-    Statements(false);
+    stmt->body = Statements(false);
 
     if (token->type == T_ELSE)
     {
-        endBlock = CreateBasicBlock("endIf");
-        if (llvmBuilder->GetInsertBlock()->getTerminator() != nullptr)
-        {
-            llvmBuilder->SetInsertPoint(elseBlock);
-        }
-        else
-        {
-            llvmBuilder->CreateBr(endBlock);
-            llvmBuilder->SetInsertPoint(elseBlock);
-        }
-
         // else block statements
-        Statements(true);
+        stmt->hasElse = true;
+        stmt->elseBody = Statements(true);
     }
 
     if (token->type != T_END)
     {
         ReportMissingTokenError("END");
-        return;
+        return nullptr;
     }
 
     if (!ValidateToken(T_IF))
     {
         ReportMissingTokenError("IF");
-        return;
+        return nullptr;
     }
 
+    return stmt;
+}
 
-    bool isNullTerm = (llvmBuilder->GetInsertBlock()->getTerminator() == nullptr);
-    if (endBlock != nullptr)
-    {
-        // go from else to end
-        if (isNullTerm)
-        {
-            llvmBuilder->CreateBr(endBlock);
-        }
-
-        llvmBuilder->SetInsertPoint(endBlock);
-    }
-    else
-    {
-        // go from if to else
-        if (isNullTerm)
-        {
-            llvmBuilder->CreateBr(elseBlock);
-        }
-
-        llvmBuilder->SetInsertPoint(elseBlock);
-    }
-}
-
-// <loop_statement>
-void Parser::LoopStatement()
-{
-    if (!ValidateToken(T_FOR))
+// <loop_statement>
+ast_stmt_t *Parser::LoopStatement()
+{
+    if (!ValidateToken(T_FOR))
     {
         ReportMissingTokenError("FOR");
-        return;
+        return nullptr;
     }
 
     if (!ValidateToken(T_LPAREN))
     {
         ReportMissingTokenError("(");
-        return;
+        return nullptr;
     }
 
     // Parse the assignment statement in the for loop
-    AssignmentStatement();
+    ast_stmt_t *stmt = ast.New<ast_stmt_t>();
+    stmt->kind = AST_LOOP;
+    stmt->init = AssignmentStatement();
 
     if (!ValidateToken(T_SEMICOLON))
     {
         ReportMissingTokenError(";");
-        return;
+        return nullptr;
     }
 
-    llvm::BasicBlock *loopStart = CreateBasicBlock("loopStart");
-    llvm::BasicBlock *loopBody = CreateBasicBlock("loopBody"); // (<statement>;)*
-    llvm::BasicBlock *loopEnd = CreateBasicBlock("loopEnd");
-
-    // jump to start
-    llvmBuilder->CreateBr(loopStart);
-    llvmBuilder->SetInsertPoint(loopStart);
-
     // Condition should be a boolean
-    Symbol expected = Symbol();
-    expected.SetType(T_BOOL);
-    Symbol expr = Symbol();
-    Expression(expected, expr);
+    expr_t expr;
+    Expression(T_BOOL, expr);
 
     // Do type conversion if alllowed
-    if (expr.GetType() == T_INTEGER)
+    if (expr.type == T_INTEGER)
     {
         ReportWarning("Converting integer to boolean");
-        llvm::Value *val = llvmBuilder->CreateICmpNE(expr.GetValue(), CreateConstantInt(32, 0, llvmBuilder->getInt32Ty()));
-        expr.SetValue(val);
+        expr.node = NewExpr(AST_CONVERT, T_BOOL, expr.node);
     }
-    else if (expr.GetType() != T_BOOL)
+    else if (expr.type != T_BOOL)
     {
         ReportError("Condition in loop must evaluate to bool (or int)");
-        return;
+        return nullptr;
     }
 
     if (!ValidateToken(T_RPAREN))
     {
         ReportMissingTokenError(")");
-        return;
+        return nullptr;
     }
 
-    // Jump to body or end based on expression
-    llvmBuilder->CreateCondBr(expr.GetValue(), loopBody, loopEnd);
-    llvmBuilder->SetInsertPoint(loopBody);
-
     // Get all statements
-    Statements(true);
+    stmt->expr = expr.node;
+    stmt->body = Statements(true);
 
     if (token->type != T_END)
     {
         ReportMissingTokenError("END");
-        return;
+        return nullptr;
     }
 
     if (!ValidateToken(T_FOR))
     {
         ReportMissingTokenError("FOR");
-        return;
+        return nullptr;
     }
 
-    // Jump to start to check if loop should continue
-    llvmBuilder->CreateBr(loopStart);
-    llvmBuilder->SetInsertPoint(loopEnd);
+    return stmt;
 }
 
 // <return_statement>
-void Parser::ReturnStatement()
+ast_stmt_t *Parser::ReturnStatement()
 {
     if (!ValidateToken(T_RETURN))
     {
         ReportMissingTokenError("RETURN");
-        return;
+        return nullptr;
     }
 
     // Currently if there is any return statement in the "main" program scope, it just gets ignored and
@@ -1144,196 +1392,162 @@ void Parser::ReturnStatement()
     //
     // If a return is put in the main scope, i.e <program_body>, user will be warned that this return will be replaced
     // with "return 0;"
-    Symbol proc = symbolTable.GetScopeProc();
+    ast_stmt_t *stmt = ast.New<ast_stmt_t>();
+    const Symbol &proc = symbolTable.GetSymbol(symbolTable.GetScopeProc());
     if (!proc.IsValid())
     {
         ReportWarning("Return statements in this scope are ignored");
 
-        llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-        llvm::APInt zeroAPInt = llvm::APInt(32, 0, true);
-
-        llvmBuilder->CreateRet(CreateConstantInt(32, 0, intType));
-        Symbol expr = Symbol();
-        Expression(proc, expr);
-        return;
+        stmt->kind = AST_PROGRAM_RETURN;
+        expr_t expr;
+        Expression(proc.GetType(), expr);
+        stmt->expr = expr.node;
+        return stmt;
     }
 
     // Get expression
-    Symbol expr = Symbol();
-    Expression(proc, expr);
-    ValidateAssignment(proc, expr);
-    if (!expr.IsValid()) {
-        return;
+    expr_t expr;
+    Expression(proc.GetType(), expr);
+    ValidateAssignment(proc.GetType(), expr);
+    if (!expr.isValid) {
+        return nullptr;
     }
 
     // Create return
-    llvmBuilder->CreateRet(expr.GetValue());
+    stmt->kind = AST_RETURN;
+    stmt->expr = expr.node;
+    return stmt;
 }
 
 // Index the symbol passed in
-void Parser::IndexArray(Symbol &symbol)
+void Parser::IndexArray(expr_t &symbol)
 {
-    symbol.SetIsArrayIndexed(true);
-    Symbol sym = Symbol();
+    symbol.isIndexed = true;
+    symbol.node = nullptr;
+    const Symbol &array = symbolTable.GetSymbol(symbol.symbol);
 
     // I believe this should already be true, just double check.
     if (token->type == T_LBRACKET)
     {
-        sym.SetType(T_INTEGER);
-        Symbol idx = Symbol();
-        Expression(sym, idx);
-        ValidateAssignment(sym, idx);
+        expr_t idx;
+        Expression(T_INTEGER, idx);
+        ValidateAssignment(T_INTEGER, idx);
 
-        if (idx.GetType() != T_INTEGER)
+        if (idx.type != T_INTEGER)
         {
             ReportError("Array index must be an integer.");
-            symbol.SetIsValid(false);
+            symbol.isValid = false;
             return;
         }
 
-        if (!symbol.IsArray())
+        if (!array.IsArray())
         {
             ReportError("Indexing not supported for non-arrays");
-            symbol.SetIsValid(false);
+            symbol.isValid = false;
             return;
         }
 
         if (!ValidateToken(T_RBRACKET))
         {
             ReportMissingTokenError("]");
-            symbol.SetIsValid(false);
+            symbol.isValid = false;
             return;
         }
 
-        // Make sure that the index is within the array bound
-        llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-        llvm::Value *address = nullptr;
-
-        // Create check for array bounds
-        llvm::Value *lowerBound = llvmBuilder->CreateICmpSLT(idx.GetValue(), symbol.GetLLVMArraySize());
-        llvm::Value *upperBound = llvmBuilder->CreateICmpSGE(idx.GetValue(), CreateConstantInt(32, 0, intType));
-        llvm::Value *checkVal = llvmBuilder->CreateAnd(upperBound, lowerBound);
-
-        llvm::BasicBlock *oob = CreateBasicBlock("oob");
-        llvm::BasicBlock *validIdx = CreateBasicBlock("validIdx");
-
-        llvmBuilder->CreateCondBr(checkVal, validIdx, oob);
-        llvmBuilder->SetInsertPoint(oob);
-
-        // for any out of bounds errors
-        // this is treated as a runtime exception as the syntax would still be perfectly valid
-        // and theres no way to tell the size at this point
-        //  i.e. variable x : integer[2]
-        //       x[100] := 1; this syntax is still valid in the eyes of the parser
-        auto oobError = symbolTable.FindSymbol("OOB_ERROR").GetFunction(); // safe because i add this myself
-        llvmBuilder->CreateCall(oobError);
-        llvmBuilder->CreateBr(validIdx);
-        llvmBuilder->SetInsertPoint(validIdx);
-
-        if (symbol.IsGlobal())
-        {
-            address = llvmBuilder->CreateInBoundsGEP(symbol.GetArrayAddress(), {CreateConstantInt(32, 0, intType), idx.GetValue()});
-        }
-        else
-        {
-            address = llvmBuilder->CreateGEP(symbol.GetArrayAddress(), idx.GetValue());
-        }
-
-        symbol.SetAddress(address);
+        // Bounds are checked when the element is reached, see CodeGen::IndexArray()
+        symbol.node = NewExpr(AST_VARIABLE, symbol.type, idx.node);
+        symbol.node->op = AST_ACCESS_INDEX;
+        symbol.node->symbol = symbol.symbol;
         return;
     }
 
     ReportMissingTokenError("[");
-    sym.SetIsValid(false);
     return;
 }
 
 // This function checks that the destination and expression evaluate to the same type,
 // or interoperable types, and does any type conversions if necessary. Converting from one type to another
 // will yield a warning to user.
-void Parser::ValidateAssignment(Symbol lhs, Symbol &rhs)
+void Parser::ValidateAssignment(int lhsType, expr_t &rhs)
 {
-    if (lhs.GetType() == rhs.GetType())
+    if (lhsType == rhs.type)
     {
         return;
     }
 
     bool isDiff = true;
-    llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
 
     // int -> bool
-    if (lhs.GetType() == T_BOOL && rhs.GetType() == T_INTEGER)
+    if (lhsType == T_BOOL && rhs.type == T_INTEGER)
     {
         isDiff = false;
-        rhs.SetType(T_BOOL);
+        rhs.type = T_BOOL;
         ReportWarning("Converting int to bool");
-        llvm::Value *val = llvmBuilder->CreateICmpNE(rhs.GetValue(), CreateConstantInt(32, 0, intType));
-        rhs.SetValue(val);
     }
 
-    if (lhs.GetType() == T_INTEGER)
+    if (lhsType == T_INTEGER)
     {
         // bool -> int
 
-        if (rhs.GetType() == T_BOOL)
+        if (rhs.type == T_BOOL)
         {
-            rhs.SetType(T_INTEGER);
+            rhs.type = T_INTEGER;
             isDiff = false;
             ReportWarning("Converting bool to int");
-            llvm::Value *val = llvmBuilder->CreateZExtOrTrunc(rhs.GetValue(), intType);
-            rhs.SetValue(val);
         }
-        else if (rhs.GetType() == T_FLOAT) // float -> int
+        else if (rhs.type == T_FLOAT) // float -> int
         {
-            rhs.SetType(T_INTEGER);
+            rhs.type = T_INTEGER;
             isDiff = false;
             ReportWarning("Converting float to int");
-            llvm::Value *val = llvmBuilder->CreateFPToSI(rhs.GetValue(), intType);
-            rhs.SetValue(val);
         }
     }
 
     // int -> float
-    if (lhs.GetType() == T_FLOAT && rhs.GetType() == T_INTEGER)
+    if (lhsType == T_FLOAT && rhs.type == T_INTEGER)
     {
         isDiff = false;
         ReportWarning("Converting int to float");
-        rhs.SetType(T_FLOAT);
-        llvm::Value *val = llvmBuilder->CreateSIToFP(rhs.GetValue(), llvmBuilder->getFloatTy());
-        rhs.SetValue(val);
+        rhs.type = T_FLOAT;
     }
 
     // If we get here, no suitable conversion was found and the types do not match, nor are they interoperable
     if (isDiff)
     {
-        std::string errorStr = "Expected: " + TypeToString(lhs.GetType()) + "\n";
-        errorStr += "\tActual: " + TypeToString(rhs.GetType()) + "\n";
+        std::string errorStr = "Expected: " + TypeToString(lhsType) + "\n";
+        errorStr += "\tActual: " + TypeToString(rhs.type) + "\n";
         ReportError(errorStr);
 
-        rhs.SetIsValid(false);
+        rhs.isValid = false;
         return;
     }
+
+    // CodeGen converts from the operand's type to the node's
+    if (rhs.node != nullptr)
+    {
+        rhs.node = NewExpr(AST_CONVERT, rhs.type, rhs.node);
+    }
 }
 
 // <destination>
-Symbol Parser::Destination()
+expr_t Parser::Destination()
 {
-    std::string id = Identifier();
-    Symbol dest = symbolTable.FindSymbol(id);
+    uint32_t id = Identifier();
+    uint32_t handle = symbolTable.FindSymbol(id);
+    const Symbol &symbol = symbolTable.GetSymbol(handle);
+    expr_t dest = GetSymbolExpr(handle);
 
-    if (!dest.IsValid())
+    if (!symbol.IsValid())
     {
-        ReportError("Symbol: " + id + " not found");
+        ReportError("Symbol: " + scanner.GetInterner()->GetName(id) + " not found");
         return dest;
     }
 
-    if (dest.GetDeclarationType() != T_VARIABLE)
+    if (symbol.GetDeclarationType() != T_VARIABLE)
     {
         ReportError("Variable required for valid destination");
-        dest = Symbol();
-        dest.SetIsValid(false);
-
-//        out.CopySymbol(dest);
+        dest = expr_t();
+        dest.isValid = false;
         return dest;
     }
 
@@ -1341,162 +1555,195 @@ Symbol Parser::Destination()
     if (ValidateToken(T_LBRACKET))
     {
         IndexArray(dest);
+        return dest;
     }
-    else // if it is an array with no index, then we unroll the array to operate on the entire thing
+
+    dest.node = NewExpr(AST_VARIABLE, dest.type);
+    dest.node->symbol = handle;
+    dest.node->op = AST_ACCESS_SCALAR;
+
+    // if it is an array with no index, then we unroll the array to operate on the entire thing
+    if (symbol.IsArray())
     {
-        // unroll
-        if (dest.IsArray())
-        {
-            dest.SetIsArrayIndexed(true);
-            doUnroll = true;
-            unrollSize = dest.GetArraySize();
-            llvm::Value *addr = nullptr;
+        dest.isIndexed = true;
+        doUnroll = true;
+        unrollSize = symbol.GetArraySize();
+        dest.node->op = AST_ACCESS_UNROLL;
+    }
 
-            // Zero index
-            llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-            llvm::Value *zero = CreateConstantInt(32, 0, intType);
-            unrollIdx = zero;
+    // If we get here, the destination is valid
+    return dest;
+}
 
-            // Store the index
-            unrollIdxAddress = llvmBuilder->CreateAlloca(intType);
-            llvmBuilder->CreateStore(unrollIdx, unrollIdxAddress);
+// Binding power of each binary operator from T_AND to T_NOTEQ, higher binds tighter
+static const int bindingPowers[T_NOTEQ - T_AND + 1] = {
+    PREC_LOGICAL, PREC_LOGICAL,                     // & |
+    PREC_ARITH, PREC_ARITH,                         // + -
+    PREC_TERM, PREC_TERM,                           // * /
+    PREC_RELATION, PREC_RELATION, PREC_RELATION,    // < > <=
+    PREC_RELATION, PREC_RELATION, PREC_RELATION     // >= == !=
+};
 
-            // Blocks for unrolling loop
-            unrollLoopStart = CreateBasicBlock("unrollLoopStart");
-            llvm::BasicBlock *unrollLoopBody = CreateBasicBlock("unrollLoopBody");
-            unrollLoopEnd = CreateBasicBlock("unrollLoopEnd");
+static int BindingPower(int tokenType)
+{
+    if (tokenType < T_AND || tokenType > T_NOTEQ)
+    {
+        return PREC_NONE;
+    }
+    return bindingPowers[tokenType - T_AND];
+}
 
-            // Jump to the loop start and load index
-            llvmBuilder->CreateBr(unrollLoopStart);
-            llvmBuilder->SetInsertPoint(unrollLoopStart);
-            unrollIdx = llvmBuilder->CreateLoad(intType, unrollIdxAddress);
+// <expression>
+//
+// Operator precedence parsing. Every operand is parsed once by Factor(), and each operator is type
+// checked and generated once, when it is reduced. Operators of the same precedence group to the
+// right (a - b - c is a - (b - c)), same as the recursive <expression>/<arith_op>/<relation>/<term>
+// rules this replaces, so the generated code is the same. Operands and operators wait on stacks
+// kept in the parser, so a long chain of operators doesn't use any more of the call stack.
+void Parser::Expression(int expectedType, expr_t &out)
+{
+    if (IsNestedTooDeep())
+    {
+        out.isValid = false;
+        return;
+    }
+    NestingLevel level(nestingDepth);
 
-            // Check if index equals the size, if it does jump to the end
-            llvm::Value *cmp = llvmBuilder->CreateICmpEQ(unrollIdx, dest.GetLLVMArraySize());
-            llvmBuilder->CreateCondBr(cmp, unrollLoopEnd, unrollLoopBody);
+    bool isNotOp = ValidateToken(T_NOT) ? true : false;
 
-            // Set the insert point to the loop body so that the expression of the assignment statement
-            // goes in the body
-            llvmBuilder->SetInsertPoint(unrollLoopBody);
-            unrollIdx = llvmBuilder->CreateLoad(intType, unrollIdxAddress);
+    // Nested expressions (parentheses, arguments, indexes) use the stacks above these
+    size_t operandBase = exprOperands.size();
+    size_t operatorBase = exprOperators.size();
 
-            if (dest.IsGlobal())
-            {
-                addr = llvmBuilder->CreateInBoundsGEP(dest.GetArrayAddress(), {zero, unrollIdx});
-            }
-            else
-            {
-                addr = llvmBuilder->CreateGEP(dest.GetArrayAddress(), unrollIdx);
-            }
+    expr_t operand;
+    Factor(expectedType, operand);
+    exprOperands.push_back(operand);
 
-            dest.SetAddress(addr);
+    while (true)
+    {
+        int op = scanner.PeekToken()->type;
+        int power = BindingPower(op);
+        if (power == PREC_NONE)
+        {
+            break;
+        }
 
+        // Operators that bind tighter than this one have both of their operands now
+        while (exprOperators.size() > operatorBase && BindingPower(exprOperators.back()) > power)
+        {
+            ReduceOperator(expectedType, false);
         }
+
+        ValidateToken(op);
+        exprOperators.push_back(op);
+
+        Factor(expectedType, operand);
+        exprOperands.push_back(operand);
     }
 
-    // If we get here, the destination is valid
-    return dest;
-}
+    // The bottom operator is applied last, so a not applies to its result. If there is no &/| the
+    // not is checked and applied on its own.
+    bool notApplied = false;
+    while (exprOperators.size() > operatorBase)
+    {
+        bool isLast = (exprOperators.size() == operatorBase + 1);
+        bool applyNot = (isNotOp && isLast && BindingPower(exprOperators.back()) == PREC_LOGICAL);
+        ReduceOperator(expectedType, applyNot);
+        notApplied = notApplied || applyNot;
+    }
 
-// <expression>
-void Parser::Expression(Symbol expectedType, Symbol &out)
-{
-    bool isNotOp = ValidateToken(T_NOT) ? true : false;
+    expr_t result = exprOperands.back();
+    exprOperands.resize(operandBase);
 
-    Symbol arithOp =Symbol();
-    ArithOp(expectedType, arithOp);
-    token_t *op = scanner.PeekToken();
-    Symbol expr_ = Symbol();
-    Expression_(expectedType, expr_);
+    if (isNotOp && !notApplied)
+    {
+        expr_t none;
+        none.isValid = false;
+        ValidateExpression(expectedType, result, none, T_NOT, true, out);
+        return;
+    }
 
-    ValidateExpression(expectedType, arithOp, expr_, op, isNotOp, out);
+    out = result;
 }
 
-// <expression>
-void Parser::Expression_(Symbol expectedType, Symbol &out)
+// Applies the operator on top of the stack to the top two operands
+void Parser::ReduceOperator(int expectedType, bool isNotOp)
 {
-    if (ValidateToken(T_AND) || ValidateToken(T_OR))
-    {
-        Symbol arithOp = Symbol();
-        ArithOp(expectedType, arithOp);
-        token_t *op = scanner.PeekToken();
-        Symbol expr_ = Symbol();
-        Expression_(expectedType, expr_);
+    int op = exprOperators.back();
+    exprOperators.pop_back();
 
-        ValidateExpression(expectedType, arithOp, expr_, op, false, out);
-        return;
+    expr_t rhs = exprOperands.back();
+    exprOperands.pop_back();
+    expr_t lhs = exprOperands.back();
+    exprOperands.pop_back();
+
+    expr_t result;
+    switch (BindingPower(op))
+    {
+        case PREC_LOGICAL:
+            ValidateExpression(expectedType, lhs, rhs, op, isNotOp, result);
+            break;
+        case PREC_RELATION:
+            ValidateRelation(lhs, rhs, op, result);
+            break;
+        default:
+            ValidateArithOp(expectedType, lhs, rhs, op, result);
+            break;
     }
 
-    Symbol sym = Symbol();
-    sym.SetIsValid(false);
-    out.CopySymbol(sym);
+    exprOperands.push_back(result);
 }
 
-// Verify expression is valid, types match, do codegen
-void Parser::ValidateExpression(Symbol expectedType, Symbol arithOp, Symbol expr_, token_t *op, bool isNotOp, Symbol &out)
+// Verify expression is valid, types match, build the node
+void Parser::ValidateExpression(int expectedType, expr_t arithOp, expr_t expr_, int op, bool isNotOp, expr_t &out)
 {
-    if (expr_.IsValid())
+    if (expr_.isValid)
     {
         // There is an operation if we get here
-        Symbol sym = Symbol();
+        expr_t sym;
         bool isInterop = false;
         std::string opStr;
 
         // check if types are interoperable
-        int expectedTy = expectedType.GetType();
+        int expectedTy = expectedType;
         switch (expectedTy)
         {
             case T_BOOL:
                 opStr = "logical";
-                isInterop = (arithOp.GetType() == T_BOOL && expr_.GetType() == T_BOOL);
-                sym.SetType(T_BOOL);
+                isInterop = (arithOp.type == T_BOOL && expr_.type == T_BOOL);
+                sym.type = T_BOOL;
                 break;
             case T_INTEGER:
             case T_FLOAT:
                 opStr = "binary";
-                isInterop = (arithOp.GetType() == T_INTEGER && expr_.GetType() == T_INTEGER);
-                sym.SetType(T_INTEGER);
+                isInterop = (arithOp.type == T_INTEGER && expr_.type == T_INTEGER);
+                sym.type = T_INTEGER;
                 break;
             default:
                 ReportError("Invalid type");
-                sym.SetIsValid(false);
-                out.CopySymbol(sym);
+                sym.isValid = false;
+                out = sym;
                 return;
         }
 
         if (!isInterop)
         {
-            ReportIncompatibleTypeError(opStr, TypeToString(arithOp.GetType()), TypeToString(expr_.GetType()));
-            sym.SetIsValid(false);
-            out.CopySymbol(sym);
+            ReportIncompatibleTypeError(opStr, TypeToString(arithOp.type), TypeToString(expr_.type));
+            sym.isValid = false;
+            out = sym;
             return;
         }
 
         // Create the appropriate operation
-        llvm::Value *val;
-        llvm::Value *arithVal = arithOp.GetValue();
-        llvm::Value *exprVal = expr_.GetValue();
-        switch (op->type)
-        {
-            case T_AND:
-                val = llvmBuilder->CreateAnd(arithVal, exprVal);
-                break;
-            case T_OR:
-                val = llvmBuilder->CreateOr(arithVal, exprVal);
-                break;
-            default:
-                printf("No operation found");
-        }
-
-        sym.SetValue(val);
+        sym.node = NewExpr(AST_BINARY, sym.type, arithOp.node, expr_.node);
+        sym.node->op = op;
 
         // Create Not operation if one should exist
         if (isNotOp)
         {
-            val = llvmBuilder->CreateNot(sym.GetValue());
-            sym.SetValue(val);
+            sym.node = NewExpr(AST_NOT, sym.type, sym.node);
         }
-        out.CopySymbol(sym);
+        out = sym;
         return;
     }
     else
@@ -1505,15 +1752,15 @@ void Parser::ValidateExpression(Symbol expectedType, Symbol arithOp, Symbol expr
         {
             // check if types are interoperable
             bool isInterop = false;
-            int expectedTy = expectedType.GetType();
+            int expectedTy = expectedType;
             switch (expectedTy)
             {
                 case T_BOOL:
-                    isInterop = (arithOp.GetType() == T_BOOL);
+                    isInterop = (arithOp.type == T_BOOL);
                     break;
                 case T_INTEGER:
                 case T_FLOAT:
-                    isInterop = (arithOp.GetType() == T_INTEGER);
+                    isInterop = (arithOp.type == T_INTEGER);
                     break;
                 default:
                     break;
@@ -1521,85 +1768,41 @@ void Parser::ValidateExpression(Symbol expectedType, Symbol arithOp, Symbol expr
 
             if (!isInterop)
             {
-                ReportIncompatibleTypeError("binary", TypeToString(arithOp.GetType()), "null");
-                Symbol sym = Symbol();
-                sym.SetIsValid(false);
-                out.CopySymbol(sym);
+                ReportIncompatibleTypeError("binary", TypeToString(arithOp.type), "null");
+                expr_t sym;
+                sym.isValid = false;
+                out = sym;
                 return;
             }
 
             // Create Not operation
-            llvm::Value *val = llvmBuilder->CreateNot(arithOp.GetValue());
-            arithOp.SetValue(val);
+            arithOp.node = NewExpr(AST_NOT, arithOp.type, arithOp.node);
         }
 
         // expr_ was not valid, return arithOp
-        out.CopySymbol(arithOp);
+        out = arithOp;
         return;
     }
 }
 
-// <arith_op>
-void Parser::ArithOp(Symbol expectedType, Symbol &out)
+// Verify arithOp is valid, types match, build the node
+void Parser::ValidateArithOp(int expectedType, expr_t rel, expr_t arithOp_, int op, expr_t &out)
 {
-    Symbol rel = Symbol();
-    Relation(expectedType, rel);
-    token_t *op = scanner.PeekToken();
-    Symbol arithOp_ = Symbol();
-    ArithOp_(expectedType, arithOp_);
-
-    ValidateArithOp(expectedType, rel, arithOp_, op, out);
-}
-
-// <arith_op>
-void Parser::ArithOp_(Symbol expectedType, Symbol &out)
-{
-    if (ValidateToken(T_ADD) || ValidateToken(T_SUBTRACT))
+    if (arithOp_.isValid)
     {
-        Symbol rel = Symbol();
-        Relation(expectedType, rel);
-        token_t *op = scanner.PeekToken();
-        Symbol arithOp_ = Symbol();
-        ArithOp_(expectedType, arithOp_);
-
-        ValidateArithOp(expectedType, rel, arithOp_, op, out);
-        return;
-    }
-
-    Symbol sym = Symbol();
-    sym.SetIsValid(false);
-    out.CopySymbol(sym);
-}
-
-// Verify arithOp is valid, types match, do codegen
-void Parser::ValidateArithOp(Symbol expectedType, Symbol rel, Symbol arithOp_, token_t *op, Symbol &out)
-{
-    if (arithOp_.IsValid())
-    {
-        Symbol sym = Symbol();
+        expr_t sym;
 
         // check if types are interoperable
         bool isInterop = false;
-        int relType = rel.GetType();
+        int relType = rel.type;
 
         switch (relType)
         {
             case T_INTEGER:
-                isInterop = (arithOp_.GetType() == T_INTEGER || arithOp_.GetType() == T_FLOAT);
-                if (isInterop && arithOp_.GetType() == T_FLOAT)
-                {
-                    // do type conversion
-                    llvm::Value *val = llvmBuilder->CreateSIToFP(rel.GetValue(), llvmBuilder->getFloatTy());
-                    rel.SetValue(val);
-                }
+                isInterop = (arithOp_.type == T_INTEGER || arithOp_.type == T_FLOAT);
                 break;
             case T_FLOAT:
-                isInterop = (arithOp_.GetType() == T_INTEGER || arithOp_.GetType() == T_FLOAT);
-                if (isInterop && arithOp_.GetType() == T_INTEGER)
-                {
-                    llvm::Value *val = llvmBuilder->CreateSIToFP(arithOp_.GetValue(), llvmBuilder->getFloatTy());
-                    arithOp_.SetValue(val);
-                }
+                isInterop = (arithOp_.type == T_INTEGER || arithOp_.type == T_FLOAT);
                 break;
             default:
                 break;
@@ -1607,425 +1810,106 @@ void Parser::ValidateArithOp(Symbol expectedType, Symbol rel, Symbol arithOp_, t
 
         if (!isInterop)
         {
-            ReportIncompatibleTypeError("arith", TypeToString(rel.GetType()), TypeToString(arithOp_.GetType()));
-            sym.SetIsValid(false);
-            out.CopySymbol(sym);
+            ReportIncompatibleTypeError("arith", TypeToString(rel.type), TypeToString(arithOp_.type));
+            sym.isValid = false;
+            out = sym;
             return;
         }
 
-        bool isFloatOp = (rel.GetType() == T_FLOAT || arithOp_.GetType() == T_FLOAT);
-
-        llvm::Value *val;
-        switch (op->type)
-        {
-            case T_ADD:
-            {
-                auto relVal = rel.GetValue();
-                auto arithVal = arithOp_.GetValue();
-                if (isFloatOp) {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::FAdd, relVal, arithVal);
-                } else {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::Add, relVal, arithVal);
-                }
-                break;
-            }
-            case T_SUBTRACT:
-            {
-                auto relVal = rel.GetValue();
-                auto arithVal = arithOp_.GetValue();
-                if (isFloatOp)
-                {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::FSub, relVal, arithVal);
-                }
-                else
-                {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::Sub, relVal, arithVal);
-                }
-                break;
-            }
-            case T_MULTIPLY:
-            {
-                auto relVal = rel.GetValue();
-                auto arithVal = arithOp_.GetValue();
-                if (isFloatOp)
-                {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::FMul, relVal, arithVal);
-                }
-                else
-                {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::Mul, relVal, arithVal);
-                }
-                break;
-            }
-            case T_DIVIDE:
-            {
-                auto relVal = rel.GetValue();
-                auto arithVal = arithOp_.GetValue();
-                if (isFloatOp)
-                {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::FDiv, relVal, arithVal);
-                }
-                else
-                {
-                    val = llvmBuilder->CreateBinOp(llvm::Instruction::SDiv, relVal, arithVal);
-                }
-                break;
-            }
-            default:
-                std::cout << "Could not find an operation" << std::endl;
-        }
-
-        sym.SetValue(val);
-
-        int expTy = expectedType.GetType();
+        // The int operand is converted if the other one is a float, see CodeGen::ArithOp()
+        int expTy = expectedType;
         switch (expTy)
         {
             case T_FLOAT:
-                // Cast to float
-                sym.SetType(T_FLOAT);
-                if (!isFloatOp)
-                {
-                    llvm::Value *val = llvmBuilder->CreateSIToFP(sym.GetValue(), llvmBuilder->getFloatTy());
-                    sym.SetValue(val);
-                }
-                break;
             case T_INTEGER:
-                sym.SetType(T_INTEGER);
-                if (isFloatOp)
-                {
-                    llvm::Value *val = llvmBuilder->CreateSIToFP(sym.GetValue(), llvmBuilder->getInt32Ty());
-                    sym.SetValue(val);
-                }
+                sym.type = expTy;
                 break;
             default:
-                if (rel.GetType() == T_FLOAT || arithOp_.GetType() == T_FLOAT)
+                if (rel.type == T_FLOAT || arithOp_.type == T_FLOAT)
                 {
-                    sym.SetType(T_FLOAT);
+                    sym.type = T_FLOAT;
                 }
                 else
                 {
-                    sym.SetType(T_INTEGER);
+                    sym.type = T_INTEGER;
                 }
                 break;
         }
 
-        out.CopySymbol(sym);
+        sym.node = NewExpr(AST_BINARY, sym.type, rel.node, arithOp_.node);
+        sym.node->op = op;
+
+        out = sym;
         return;
     }
     else
     {
         // arithOp_ was not valid
-        out.CopySymbol(rel);
-        return;
-    }
-}
-
-// <relation>
-void Parser::Relation(Symbol expectedType, Symbol &out)
-{
-    Symbol term = Symbol();
-    Term(expectedType, term);
-    token_t *op = scanner.PeekToken();
-    Symbol relation_ = Symbol();
-    Relation_(expectedType, relation_);
-
-    ValidateRelation(expectedType, term, relation_, op, out);
-}
-
-// <relation>
-void Parser::Relation_(Symbol expectedType, Symbol &out)
-{
-    if (ValidateToken(T_LESSTHAN) ||
-        ValidateToken(T_GREATERTHAN) ||
-        ValidateToken(T_LTEQ) ||
-        ValidateToken(T_GTEQ) ||
-        ValidateToken(T_EQEQ) ||
-        ValidateToken(T_NOTEQ))
-    {
-        Symbol term = Symbol();
-        Term(expectedType, term);
-        token_t *op = scanner.PeekToken();
-        Symbol relation_ = Symbol();
-        Relation_(expectedType, relation_);
-
-        ValidateRelation(expectedType, term, relation_, op, out);
+        out = rel;
         return;
     }
-
-    Symbol sym = Symbol();
-    sym.SetIsValid(false);
-    out.CopySymbol(sym);
 }
 
-// Verify relation is valid, types match, do codegen
-void Parser::ValidateRelation(Symbol expectedType, Symbol term, Symbol relation_, token_t *op, Symbol &out)
+// Verify relation is valid, types match, build the node
+void Parser::ValidateRelation(expr_t term, expr_t relation_, int op, expr_t &out)
 {
-    if (relation_.IsValid())
+    if (relation_.isValid)
     {
-        Symbol sym = Symbol();
+        expr_t sym;
         bool isInterop = false;
-        bool isFloatOp = false;
 
-        // do type conversion if necessary and allowed
-        switch (term.GetType())
+        // check the types, CodeGen::Relation() does the conversions
+        switch (term.type)
         {
             case T_BOOL:
-                isInterop = (relation_.GetType() == T_BOOL || relation_.GetType() == T_INTEGER);
-                if (isInterop && relation_.GetType() == T_INTEGER)
-                {
-                    llvm::Value *val = llvmBuilder->CreateZExtOrTrunc(term.GetValue(), llvmBuilder->getInt32Ty());
-                    term.SetValue(val);
-                }
+                isInterop = (relation_.type == T_BOOL || relation_.type == T_INTEGER);
                 break;
             case T_FLOAT:
-                isFloatOp = true;
-                isInterop = (relation_.GetType() == T_FLOAT || relation_.GetType() == T_INTEGER);
-                if (isInterop && relation_.GetType() == T_INTEGER)
-                {
-                    llvm::Value *val = llvmBuilder->CreateSIToFP(relation_.GetValue(), llvmBuilder->getFloatTy());
-                    relation_.SetValue(val);
-                }
+                isInterop = (relation_.type == T_FLOAT || relation_.type == T_INTEGER);
                 break;
             case T_INTEGER:
-                isInterop = (relation_.GetType() == T_INTEGER || relation_.GetType() == T_FLOAT || relation_.GetType() == T_BOOL);
-                if (isInterop)
-                {
-                    if (relation_.GetType() == T_BOOL)
-                    {
-                        llvm::Value *val = llvmBuilder->CreateZExtOrTrunc(relation_.GetValue(), llvmBuilder->getInt32Ty());
-                        relation_.SetValue(val);
-                    }
-                    else if (relation_.GetType() == T_FLOAT)
-                    {
-                        llvm::Value *val = llvmBuilder->CreateSIToFP(term.GetValue(), llvmBuilder->getFloatTy());
-                        term.SetValue(val);
-                        isFloatOp = true;
-                    }
-                }
+                isInterop = (relation_.type == T_INTEGER || relation_.type == T_FLOAT || relation_.type == T_BOOL);
                 break;
             case T_STRING:
-                isInterop = ((op->type == T_EQEQ || op->type == T_NOTEQ) && (relation_.GetType() == T_STRING));
+                isInterop = ((op == T_EQEQ || op == T_NOTEQ) && (relation_.type == T_STRING));
                 break;
         }
 
         if (!isInterop)
         {
-            ReportIncompatibleTypeError("relational", TypeToString(term.GetType()), TypeToString(relation_.GetType()));
-            sym.SetIsValid(false);
-            out.CopySymbol(sym);
+            ReportIncompatibleTypeError("relational", TypeToString(term.type), TypeToString(relation_.type));
+            sym.isValid = false;
+            out = sym;
             return;
         }
 
-        llvm::Value *val;
-        if (term.GetType() == T_STRING)
-        {
-            llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-            llvm::APInt oneAPInt = llvm::APInt(32, 1, true);
-
-            // Need to start at -1 because the Add instruction was incrementing the idx before we ever got
-            // to check the first character. This created issues for single character comparisons and the first
-            // character of all strings was actually never being checked, leading to incorrect comparisons.
-            //
-            // ALso i realize i could just move where the add occurs... but this works for now
-            llvm::Value *idxAddr = llvmBuilder->CreateAlloca(intType);
-            llvm::Value *idx = CreateConstantInt(32, -1, intType);
+        sym.type = T_BOOL;
+        sym.node = NewExpr(AST_BINARY, sym.type, term.node, relation_.node);
+        sym.node->op = op;
 
-            llvmBuilder->CreateStore(idx, idxAddr);
-
-            llvm::BasicBlock *strCmpStart = CreateBasicBlock("strCmpStart");
-            llvm::BasicBlock *strCmpEnd = CreateBasicBlock("strCmpEnd");
-
-            // jump to the loop start
-            llvmBuilder->CreateBr(strCmpStart);
-            llvmBuilder->SetInsertPoint(strCmpStart);
-
-            idx = llvmBuilder->CreateLoad(intType, idxAddr);
-            idx = llvmBuilder->CreateBinOp(llvm::Instruction::Add, idx, CreateConstantInt(32, 1, intType));
-            llvmBuilder->CreateStore(idx, idxAddr);
-
-            // ******* This block works *******
-            // Breaking it down to the simplest form, Compare only the first character of each string
-            // This revealed that I was attempting to load an i8* using the result of GEP, when this should
-            // in fact have just loaded an i8. Much time was wasted.
-            //
-            // Get character at 'idx' from each string, you have to create the load with i8 and not i8*
-            // as i found out after 2 weeks of trying to fix string comparison.
-            llvm::IntegerType *int8Ty = llvmBuilder->getInt8Ty();
-            llvm::Value *lhsCharacter = llvmBuilder->CreateLoad(int8Ty, llvmBuilder->CreateGEP(term.GetValue(), idx));
-            llvm::Value *rhsCharacter = llvmBuilder->CreateLoad(int8Ty, llvmBuilder->CreateGEP(relation_.GetValue(), idx));
-
-            // compare (==) the first character of lhs and rhs
-            llvm::Value *stringComparison = llvmBuilder->CreateICmpEQ(lhsCharacter, rhsCharacter);
-            // ******* This block works *******
-
-            // escCh = '\0'
-            llvm::Value *escCh = CreateConstantInt(8, 0, int8Ty);
-            llvm::Value *notDone = llvmBuilder->CreateICmpNE(lhsCharacter, escCh);
-
-            // Prev char's match and prev lhsChar was not esc char '\0', then continue
-            llvm::Value *keepGoing = llvmBuilder->CreateAnd(stringComparison, notDone);
-            llvmBuilder->CreateCondBr(keepGoing, strCmpStart, strCmpEnd);
-
-            // end
-            llvmBuilder->SetInsertPoint(strCmpEnd);
-
-            bool isEQEQ = (op->type == T_EQEQ);
-            isEQEQ ? val = stringComparison : val = llvmBuilder->CreateNot(stringComparison);
-        }
-        else
-        {
-            switch (op->type)
-            {
-                case T_LESSTHAN:
-                    if (isFloatOp)
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateFCmpOLT(termVal, relVal);
-                    }
-                    else
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateICmpSLT(termVal, relVal);
-                    }
-                    break;
-                case T_LTEQ:
-                    if (isFloatOp)
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateFCmpOLE(termVal, relVal);
-                    }
-                    else
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateICmpSLE(termVal, relVal);
-                    }
-                    break;
-                case T_GREATERTHAN:
-                    if (isFloatOp)
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateFCmpOGT(termVal, relVal);
-                    }
-                    else
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateICmpSGT(termVal, relVal);
-                    }
-                    break;
-                case T_GTEQ:
-                    if (isFloatOp)
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateFCmpOGE(termVal, relVal);
-                    }
-                    else
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateICmpSGE(termVal, relVal);
-                    }
-                    break;
-                case T_EQEQ:
-                    if (isFloatOp)
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateFCmpOEQ(termVal, relVal);
-                    }
-                    else
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateICmpEQ(termVal, relVal);
-                    }
-                    break;
-                case T_NOTEQ:
-                    if (isFloatOp)
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateFCmpONE(termVal, relVal);
-                    }
-                    else
-                    {
-                        auto termVal = term.GetValue();
-                        auto relVal = relation_.GetValue();
-                        val = llvmBuilder->CreateICmpNE(termVal, relVal);
-                    }
-                    break;
-                default:
-                    std::cout << "Could not find an operation" << std::endl;
-            }
-        }
-
-        sym.SetValue(val);
-        sym.SetType(T_BOOL);
-
-        out.CopySymbol(sym);
+        out = sym;
         return;
     }
     else
     {
-        out.CopySymbol(term);
+        out = term;
         return;
     }
 }
 
-// <term>
-void Parser::Term(Symbol expectedType, Symbol &out)
-{
-    Symbol factor = Symbol();
-    Factor(expectedType, factor);
-    token_t *op = scanner.PeekToken();
-    Symbol term_ = Symbol();
-    Term_(expectedType, term_);
-
-    ValidateArithOp(expectedType, factor, term_, op, out);
-    return;
-}
-
-// <term>
-void Parser::Term_(Symbol expectedType, Symbol &out)
-{
-    if (ValidateToken(T_DIVIDE) || ValidateToken(T_MULTIPLY))
-    {
-        Symbol factor = Symbol();
-        Factor(expectedType, factor);
-        token_t *op = scanner.PeekToken();
-        Symbol term_ = Symbol();
-        Term_(expectedType, term_);
-
-        ValidateArithOp(expectedType, factor, term_, op, out);
-        return;
-    }
-
-    Symbol sym = Symbol();
-    sym.SetIsValid(false);
-
-    out.CopySymbol(sym);
-    return;
-}
-
 // <factor>
-void Parser::Factor(Symbol expectedType, Symbol &out)
+void Parser::Factor(int expectedType, expr_t &out)
 {
     // This just follows the rules defined in the project language for <factor> syntax
-    Symbol sym = Symbol();
+    expr_t sym;
     if (ValidateToken(T_LPAREN))
     {
         Expression(expectedType, sym);
         if (!ValidateToken(T_RPAREN))
         {
             ReportMissingTokenError(")");
-            sym.SetIsValid(false);
-            out.CopySymbol(sym);
+            sym.isValid = false;
+            out = sym;
             return;
         }
     }
@@ -2046,25 +1930,19 @@ void Parser::Factor(Symbol expectedType, Symbol &out)
         else
         {
             ReportError("Expected an identifier or number literal");
-            sym.SetIsValid(false);
-            out.CopySymbol(sym);
+            sym.isValid = false;
+            out = sym;
             return;
         }
 
-        if (sym.GetType() == T_INTEGER)
-        {
-            llvm::Value *val = llvmBuilder->CreateNeg(sym.GetValue());
-            sym.SetValue(val);
-        }
-        else if (sym.GetType() == T_FLOAT)
+        if (sym.type == T_INTEGER || sym.type == T_FLOAT)
         {
-            llvm::Value *val = llvmBuilder->CreateFNeg(sym.GetValue());
-            sym.SetValue(val);
+            sym.node = NewExpr(AST_NEGATE, sym.type, sym.node);
         }
         else
         {
             std::string errorStr = "Expected: int/float\n";
-            errorStr += "\tActual: " + TypeToString(sym.GetType())+ "\n";
+            errorStr += "\tActual: " + TypeToString(sym.type)+ "\n";
             ReportError(errorStr);
         }
 
@@ -2080,38 +1958,39 @@ void Parser::Factor(Symbol expectedType, Symbol &out)
     }
     else if (ValidateToken(T_TRUE))
     {
-        sym.SetType(T_BOOL);
-        sym.SetValue(CreateConstantInt(1, 1, GetLLVMType(sym)));
+        sym.type = T_BOOL;
+        sym.node = NewExpr(AST_BOOL_LITERAL, sym.type);
+        sym.node->val.intValue = 1;
     }
     else if (ValidateToken(T_FALSE))
     {
-        sym.SetType(T_BOOL);
-        sym.SetValue(CreateConstantInt(1, 0, GetLLVMType(sym)));
+        sym.type = T_BOOL;
+        sym.node = NewExpr(AST_BOOL_LITERAL, sym.type);
     }
     else
     {
         ReportError("Factor expected");
-        sym.SetIsValid(false);
-        out.CopySymbol(sym);
+        sym.isValid = false;
+        out = sym;
         return;
     }
 
-    out.CopySymbol(sym);
+    out = sym;
     return;
 }
 
 // Combines <procedure_call> and <name> because both are <identifier>'s. The two are then differentiated here and
 // the appropriate course of action is taken for each.
-void Parser::Identifiers(Symbol &out)
+void Parser::Identifiers(expr_t &out)
 {
-    Symbol sym = Symbol();
-    std::string id = token->val.stringValue;
-    sym = symbolTable.FindSymbol(id);
+    uint32_t handle = symbolTable.FindSymbol(token->val.atom);
+    Symbol &symbol = symbolTable.GetSymbol(handle);
+    expr_t sym = GetSymbolExpr(handle);
 
-    if (!sym.IsValid())
+    if (!sym.isValid)
     {
-        ReportError("Symbol not found: " + id);
-        out.CopySymbol(sym);
+        ReportError("Symbol not found: " + scanner.GetIdentifier(token));
+        out = sym;
         return;
     }
 
@@ -2119,19 +1998,18 @@ void Parser::Identifiers(Symbol &out)
     if (ValidateToken(T_LPAREN))
     {
         // just double check that the symbol is definitely a procedure
-        if (sym.GetDeclarationType() != T_PROCEDURE)
+        if (symbol.GetDeclarationType() != T_PROCEDURE)
         {
             ReportError("Cannot call non procedure type");
-            sym = Symbol();
-            sym.SetIsValid(false);
+            sym = expr_t();
+            sym.isValid = false;
 
-            out.CopySymbol(sym);
+            out = sym;
             return;
         }
 
-        Symbol procSym = sym;
-        sym = Symbol();
-        sym.SetType(procSym.GetType());
+        sym = expr_t();
+        sym.type = symbol.GetType();
 
         // Get any arguments
         token_t *tmp = scanner.PeekToken();
@@ -2141,180 +2019,172 @@ void Parser::Identifiers(Symbol &out)
             tmp->type == T_STRING_LITERAL || tmp->type == T_TRUE ||
             tmp->type == T_FALSE)
         {
-            std::vector<llvm::Value *> arguments = ArgumentList(procSym.GetParameters());
-            llvm::Value *val = llvmBuilder->CreateCall(procSym.GetFunction(), arguments);
-            sym.SetValue(val);
+            sym.node = NewExpr(AST_CALL, sym.type, ArgumentList(symbol.GetParameters()));
         }
         else
         {
             // check that arguments aren't missing
-            if (!procSym.GetParameters().empty())
+            if (!symbol.GetParameters().empty())
             {
                 ReportError("Missing arguments for procedure");
-                sym.SetIsValid(false);
+                sym.isValid = false;
 
-                out.CopySymbol(sym);
+                out = sym;
                 return;
             }
 
-            llvm::Value *val = llvmBuilder->CreateCall(procSym.GetFunction());
-            sym.SetValue(val);
+            sym.node = NewExpr(AST_CALL, sym.type);
         }
+        sym.node->symbol = handle;
 
         if (!ValidateToken(T_RPAREN))
         {
             ReportMissingTokenError(")");
-            sym.SetIsValid(false);
+            sym.isValid = false;
 
-            out.CopySymbol(sym);
+            out = sym;
             return;
         }
     }
     else
     {
         // name, has to be a variable now
-        if (sym.GetDeclarationType() != T_VARIABLE)
+        if (symbol.GetDeclarationType() != T_VARIABLE)
         {
             ReportError("Name must be a variable");
-            sym.SetIsValid(false);
+            sym.isValid = false;
 
-            out.CopySymbol(sym);
+            out = sym;
             return;
         }
 
-        if (ValidateToken(T_LBRACKET))
+        int access = AST_ACCESS_SCALAR;
+        bool isElement = ValidateToken(T_LBRACKET);
+        if (isElement)
         {
             // array, we must index it
-            if (sym.GetDeclarationType() != T_VARIABLE)
-            {
-                ReportError("Indexing is not supported for non-arrays.");
-                sym = Symbol();
-                sym.SetIsValid(false);
-
-                out.CopySymbol(sym);
-                return;
-            }
-
             IndexArray(sym);
         }
         else if (doUnroll)
         {
             // no index, unroll array
-            if (sym.IsArray())
+            if (symbol.IsArray())
             {
-                sym.SetIsArrayIndexed(true);
-                if (sym.GetArraySize() < unrollSize)
+                sym.isIndexed = true;
+                if (symbol.GetArraySize() < unrollSize)
                 {
                     ReportError("Array size is smaller than destination size. Unroll failed.");
-                    sym = Symbol();
-                    sym.SetIsValid(false);
+                    sym = expr_t();
+                    sym.isValid = false;
 
-                    out.CopySymbol(sym);
+                    out = sym;
                     return;
                 }
 
-                // Can't believe this was the problem after like a month of looking into this...
-                // I was calling GEP on both global and local arrays, when in reality you need to
-                // call CreateInBoundsGEP for globals. This immediately fixed the issues I was
-                // encountering.
-                llvm::Value *addr = nullptr;
-                if (sym.IsGlobal())
-                {
-                    llvm::IntegerType *intType = llvmBuilder->getInt32Ty();
-                    addr = llvmBuilder->CreateInBoundsGEP(sym.GetArrayAddress(), {CreateConstantInt(32, 0, intType), unrollIdx});
-                }
-                else
-                {
-                    addr = llvmBuilder->CreateGEP(sym.GetArrayAddress(), unrollIdx);
-                }
-
-                sym.SetAddress(addr);
+                access = AST_ACCESS_UNROLL;
             }
         }
         else
         {
-            sym.SetIsArrayIndexed(false);
+            sym.isIndexed = false;
         }
 
-        if (sym.GetDeclarationType() == T_VARIABLE)
+        if (symbol.IsInitialized() == false)
         {
-            if (sym.IsInitialized() == false)
-            {
-                ReportError("Variable has not yet been initialized");
-                sym.SetIsValid(false);
+            ReportError("Variable has not yet been initialized");
+            sym.isValid = false;
 
-                out.CopySymbol(sym);
-                return;
-            }
+            out = sym;
+            return;
+        }
 
-            // Load value
-            llvm::Value *val = llvmBuilder->CreateLoad(GetLLVMType(sym), sym.GetAddress());
-            sym.SetValue(val);
+        // Load value, IndexArray() already made the node for an element
+        if (!isElement)
+        {
+            sym.node = NewExpr(AST_VARIABLE, sym.type);
+            sym.node->op = access;
+            sym.node->symbol = handle;
         }
     }
 
-    out.CopySymbol(sym);
+    out = sym;
     return;
 }
 
 // <number>
-void Parser::Number(Symbol &out)
+void Parser::Number(expr_t &out)
 {
-    Symbol sym = Symbol();
+    expr_t sym;
 
     // Is it an int or a float?
-    llvm::Value *val;
     if (token->type == T_INT_LITERAL)
     {
-        sym.SetType(T_INTEGER);
-        val = CreateConstantInt(32, token->val.intValue, GetLLVMType(sym));
+        sym.type = T_INTEGER;
+        sym.node = NewExpr(AST_INT_LITERAL, sym.type);
+        sym.node->val.intValue = token->val.intValue;
     }
     else if (token->type == T_FLOAT_LITERAL)
     {
-        sym.SetType(T_FLOAT);
-        val = llvm::ConstantFP::get(GetLLVMType(sym), llvm::APFloat(token->val.floatValue));
+        sym.type = T_FLOAT;
+        sym.node = NewExpr(AST_FLOAT_LITERAL, sym.type);
+        sym.node->val.floatValue = token->val.floatValue;
     }
 
-    sym.SetValue(val);
-
-    out.CopySymbol(sym);
+    out = sym;
     return;
 }
 
 // <string>
-void Parser::String(Symbol &out)
+void Parser::String(expr_t &out)
 {
-    out = Symbol();
+    out = expr_t();
     if (token->type != T_STRING_LITERAL)
     {
         ReportError("String literal expected.");
         return;
     }
 
-    out.SetType(T_STRING);
-    llvm::Value *val = llvmBuilder->CreateGlobalStringPtr(token->val.stringValue);
-    out.SetValue(val);
+    out.type = T_STRING;
+    // strip the quotes
+    llvm::StringRef str = scanner.GetTokenText(token).drop_front().drop_back();
+    out.node = NewExpr(AST_STRING_LITERAL, out.type);
+    out.node->text = ast.CopyString(str.data(), str.size());
+    out.node->length = str.size();
 }
 
-// Helper function to get the corresponding llvm type from the symbol
-// returns llvm::Type*
-llvm::Type *Parser::GetLLVMType(Symbol symbol)
+// Expression result for a use of the symbol, the symbol itself stays in the table
+expr_t Parser::GetSymbolExpr(uint32_t handle)
 {
-    int type = symbol.GetType();
-    switch (type)
-    {
-        case T_INTEGER:
-            return llvmBuilder->getInt32Ty();
-        case T_FLOAT:
-            return llvmBuilder->getFloatTy();
-        case T_BOOL:
-            return llvmBuilder->getInt1Ty();
-        case T_STRING:
-            return llvmBuilder->getInt8PtrTy();
-        default:
-            ReportError("Not a valid type");
-            return nullptr;
+    const Symbol &symbol = symbolTable.GetSymbol(handle);
+
+    expr_t expr;
+    expr.type = symbol.GetType();
+    expr.isValid = symbol.IsValid();
+    expr.isIndexed = symbol.IsArrayIndexed();
+    expr.symbol = handle;
+    return expr;
+}
+
+// Stops parsing once blocks, declarations or expressions are nested deeper than --max-depth, before
+// the recursion can overflow the stack. The rest of the program is skipped, so every level above
+// unwinds right away.
+bool Parser::IsNestedTooDeep()
+{
+    if (nestingDepth < options.maxDepth)
+    {
+        return false;
+    }
+
+    // report it even if there already was an error, it's why the rest of the program is ignored
+    errorFlag = false;
+    ReportError("Nested too deeply, the limit is " + std::to_string(options.maxDepth) + " levels (see --max-depth)");
+    sucessfulResync = false;
+
+    while (scanner.PeekToken()->type != T_EOF)
+    {
+        token = scanner.GetToken();
     }
+    return true;
 }
 
 // Attempt for Resync on error
@@ -2322,6 +2192,13 @@ bool Parser::DoResync(bool isDec)
 {
 //    std::cout << token->type << std::endl;
     sucessfulResync = false;
+
+    // Nothing left to resync on (also how the levels above unwind after IsNestedTooDeep())
+    if (scanner.PeekToken()->type == T_EOF)
+    {
+        return false;
+    }
+
     ReportWarning("Attempting to resync...");
     std::vector<int> resyncTokens;
     if (isDec)
@@ -2337,7 +2214,7 @@ bool Parser::DoResync(bool isDec)
     resyncTokens.push_back(T_PERIOD);
 
     token_t *tmpToken = scanner.PeekToken();
-    while (errorFlag)
+    while (errorFlag && tmpToken->type != T_EOF)
     {
         for (int t : resyncTokens)
         {
@@ -2365,15 +2242,13 @@ bool Parser::DoResync(bool isDec)
     return false;
 }
 
-// Helper function for easily creating llvm::ConstantInt, as we need a lot of them
-llvm::Value *Parser::CreateConstantInt(int numBits, int intVal, llvm::Type *type)
-{
-    llvm::APInt intValue = llvm::APInt(numBits, intVal, true);
-    return llvm::ConstantInt::getIntegerValue(type, intValue);
-}
-
-// Helper function for quickly creating llvm::BasicBlock
-llvm::BasicBlock *Parser::CreateBasicBlock(std::string name)
+// New expression node of the given kind and type
+ast_expr_t *Parser::NewExpr(int kind, int type, ast_expr_t *lhs, ast_expr_t *rhs)
 {
-    return llvm::BasicBlock::Create(llvmContext, name , llvmCurrProc);
+    ast_expr_t *expr = ast.New<ast_expr_t>();
+    expr->kind = kind;
+    expr->type = type;
+    expr->lhs = lhs;
+    expr->rhs = rhs;
+    return expr;
 }
@@ -4,11 +4,31 @@
 
 #include "../include/definitions.h"
 #include "../include/Scanner.h"
+#include "../include/CharClass.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
+// Lexer core used unless SetDfaLexer() is called, build with LEXER=dfa to default to the table driven core
+//
+#ifdef SCANNER_DFA
+#define SCANNER_DFA_DEFAULT true
+#else
+#define SCANNER_DFA_DEFAULT false
+#endif
+
 /* Constructor
 
 History:
@@ -18,6 +38,22 @@ Date             Description
 */
 Scanner::Scanner()
 {
+    sourceEnd = nullptr;
+    cursor = nullptr;
+    windowBase = 0;
+    retainOffset = 0;
+    tokenStart = 0;
+    windowLine = 1;
+    windowLineStart = 0;
+    hitWindowEnd = false;
+    preTokenIndex = 0;
+    tokenArena = make_shared<TokenArena>();
+    interner = make_shared<StringInterner>();
+    lookaheadHead = 0;
+    lookaheadCount = 0;
+    bytesScanned = 0;
+    readPastEnd = false;
+    useDfa = SCANNER_DFA_DEFAULT;
 }
 
 /* Destructor
@@ -26,78 +62,83 @@ History:
 Date             Description
 ====================================================================
 21-Jan-2021      Initial
+17-Oct-2026      Source buffer is released by its shared owner
 */
 Scanner::~Scanner()
 {
-    if (filePtr != nullptr)
+}
+
+Scanner::StreamWindow::~StreamWindow()
+{
+    close(fd);
+}
+
+
+// Keyword table
+//
+// Perfect hash over the words in RESERVED_WORDS, built at compile time. The hash only looks at
+// the length and the first two characters, (c & 31) folds upper and lower case letters together.
+// Every reserved word is at least 2 characters long.
+//
+#define KEYWORD_TABLE_SIZE 64
+
+struct ReservedWord
+{
+    const char* word;
+    int type;
+};
+
+struct KeywordTable
+{
+    const char* word[KEYWORD_TABLE_SIZE];
+    int type[KEYWORD_TABLE_SIZE];
+    size_t length[KEYWORD_TABLE_SIZE];
+    bool collision;
+};
+
+static constexpr ReservedWord reservedWords[] = {
+#define RESERVED_WORD_ENTRY(word, type) { word, type },
+    RESERVED_WORDS(RESERVED_WORD_ENTRY)
+#undef RESERVED_WORD_ENTRY
+};
+
+static constexpr size_t KeywordLength(const char* word)
+{
+    size_t length = 0;
+    while (word[length] != '\0')
     {
-        fclose(filePtr);
+        length++;
     }
+    return length;
 }
 
+static constexpr unsigned KeywordHash(const char* text, size_t length)
+{
+    return (length + (text[0] & 31) + 4 * (text[1] & 31)) & (KEYWORD_TABLE_SIZE - 1);
+}
 
-/*
-Method: GenerateReservedTable()
-Description: Map values to tokens defined in definitions.h
+static constexpr KeywordTable GenerateKeywordTable()
+{
+    KeywordTable table = {};
+    for (const ReservedWord& reserved : reservedWords)
+    {
+        size_t length = KeywordLength(reserved.word);
+        unsigned hash = KeywordHash(reserved.word, length);
+        if (table.word[hash] != nullptr)
+        {
+            table.collision = true;
+        }
 
-History:
-Date             Description
-====================================================================
-22-Jan-2021      Initial
-*/
-std::map<std::string, int> Scanner::GenerateReservedTable()
-{
-    std::map<std::string, int> map;
-
-    map[";"]  = T_SEMICOLON;
-    map["."]  = T_PERIOD;
-    map["("]  = T_LPAREN;
-    map[")"]  = T_RPAREN;
-    map[","]  = T_COMMA;
-    map["["]  = T_LBRACKET;
-    map["]"]  = T_RBRACKET;
-    map["{"]  = T_LBRACE;
-    map["}"]  = T_RBRACE;
-    map["&"]  = T_AND;
-    map["|"]  = T_OR;
-    map["+"]  = T_ADD;
-    map["-"]  = T_SUBTRACT;
-    map["*"]  = T_MULTIPLY;
-    map["/"]  = T_DIVIDE;
-    map["<"]  = T_LESSTHAN;
-    map[">"]  = T_GREATERTHAN;
-    map["<="] = T_LTEQ;
-    map[">="] = T_GTEQ;
-    map["=="] = T_EQEQ;
-    map["!="] = T_NOTEQ;
-    map[":="] = T_ASSIGNMENT;
-    map[":"]  = T_COLON;
-
-    map["PROGRAM"]  = T_PROGRAM;
-    map["IS"]       = T_IS;
-    map["BEGIN"]    = T_BEGIN;
-    map["END"]      = T_END;
-    map["GLOBAL"]   = T_GLOBAL;
-    map["PROCEDURE"]= T_PROCEDURE;
-    map["VARIABLE"] = T_VARIABLE;
-    map["TYPE"]     = T_TYPE;
-    map["IF"]       = T_IF;
-    map["THEN"]     = T_THEN;
-    map["ELSE"]     = T_ELSE;
-    map["RETURN"]   = T_RETURN;
-    map["NOT"]      = T_NOT;
-    map["TRUE"]     = T_TRUE;
-    map["FALSE"]    = T_FALSE;
-    map["FOR"]      = T_FOR;
-
-    map["INTEGER"]  = T_INTEGER;
-    map["FLOAT"]    = T_FLOAT;
-    map["STRING"]   = T_STRING;
-    map["BOOL"]     = T_BOOL;
-
-    return map;
+        table.word[hash] = reserved.word;
+        table.type[hash] = reserved.type;
+        table.length[hash] = length;
+    }
+    return table;
 }
 
+static constexpr KeywordTable keywordTable = GenerateKeywordTable();
+static_assert(!keywordTable.collision, "RESERVED_WORDS changed, pick a new KeywordHash()");
+
 
 /*
 Method: InitScanner()
@@ -107,26 +148,340 @@ History:
 Date             Description
 ====================================================================
 21-Jan-2021      Initial
+17-Oct-2026      Load the whole source into a single buffer
+17-Oct-2026      Reset the token arena
+17-Oct-2026      "-" reads the program from stdin
+17-Oct-2026      Line/column numbers are computed from offsets, see GetLocation()
+17-Oct-2026      Refuse sources over SCANNER_MAX_SOURCE instead of wrapping their offsets
 */
 bool Scanner::InitScanner(string fileName)
 {
-    lineCount = 1;
-    colCount = 1;
-    filePtr = fopen(fileName.c_str(), "r");
+    lookaheadHead = 0;
+    lookaheadCount = 0;
+    bytesScanned = 0;
+    tokenArena->Reset(); // tokens from a previous compilation are no longer needed
+    stream = nullptr;
+    windowBase = 0;
+    retainOffset = 0;
+    holes.clear();
+    windowLine = 1;
+    windowLineStart = 0;
+    lineStarts = nullptr;
+    preTokens = nullptr;
+    preTokenIndex = 0;
+    preTokenBytes = nullptr;
+    pipeline = nullptr; // stops the lexer thread of a previous compilation
+    if (comments != nullptr)
+    {
+        comments->clear();
+    }
+    int fd = (fileName == "-") ? dup(STDIN_FILENO) : open(fileName.c_str(), O_RDONLY);
 
-    // handle non-existent file pointer
-    if (filePtr == nullptr)
+    // handle non-existent file
+    if (fd < 0 || !LoadSource(fd))
     {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
         cout << "File: " << fileName << " cannot be opened" << endl;
         return false;
     }
 
-    reservedTable = this->GenerateReservedTable();
+    // a streamed input is checked as it is read, see RefillWindow()
+    if (stream == nullptr && GetSourceSize() > SCANNER_MAX_SOURCE)
+    {
+        close(fd);
+        source = nullptr;
+        cursor = sourceEnd = nullptr;
+        cout << "File: " << fileName << " is too large, the limit is " << SCANNER_MAX_SOURCE << " bytes" << endl;
+        return false;
+    }
+
+    // a streamed input keeps reading from fd, the window closes it
+    if (stream == nullptr)
+    {
+        close(fd);
+    }
 
     return true;
 }
 
 
+/*
+Method: LoadSource()
+Description: Map the source file into memory. Inputs that can't be mapped (pipes, character
+             devices, empty files) are streamed through a sliding window instead, see RefillWindow().
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Stream non-seekable input instead of reading all of it
+*/
+bool Scanner::LoadSource(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        size_t size = st.st_size;
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            madvise(map, size, MADV_SEQUENTIAL);
+            source = shared_ptr<const char>((const char*)map, [size](const char* p) { munmap((void*)p, size); });
+            cursor = source.get();
+            sourceEnd = cursor + size;
+            return true;
+        }
+    }
+
+    // Non-seekable input, the window starts empty and the first token scanned fills it
+    stream = make_shared<StreamWindow>();
+    stream->fd = fd;
+    stream->eof = false;
+    stream->tooLarge = false;
+    stream->buffer.resize(SCANNER_CHUNK_SIZE);
+
+    // aliasing constructor, the window owns the bytes
+    source = shared_ptr<const char>(stream, stream->buffer.data());
+    cursor = source.get();
+    sourceEnd = cursor;
+    return true;
+}
+
+
+/*
+Method: RefillWindow()
+Description: Reads the next chunk of a streamed input. Everything before the last token handed
+             out is dropped and the rest is moved to the front of the window, so the window only
+             holds the current token, the lookahead queue and one chunk. The trivia skipped from
+             dropFrom up to the cursor is dropped as well, the bytes after it move down over it and
+             leave a hole (see WindowOffset()). The window only grows when a single token doesn't
+             fit, and then doubles. Returns false if there is nothing more to read.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Drop skipped trivia, grow geometrically and fill the whole window
+17-Oct-2026      Stop at SCANNER_MAX_SOURCE
+*/
+bool Scanner::RefillWindow(size_t dropFrom)
+{
+    if (!StreamHasMore())
+    {
+        return false;
+    }
+
+    vector<char>& buffer = stream->buffer;
+    char* base = buffer.data();
+    size_t keep = WindowPointer(retainOffset) - base;
+    size_t dropIndex = WindowPointer(dropFrom) - base;
+    size_t cursorIndex = cursor - base;
+    size_t live = sourceEnd - base;
+
+    // Count the lines that leave the window, GetLocation() can't see them anymore
+    size_t line, lineStart;
+    CountLines(retainOffset, line, lineStart);
+    windowLine = line;
+    windowLineStart = lineStart;
+
+    size_t kept = 0;
+    for (const WindowHole& hole : holes)
+    {
+        if (hole.offset > retainOffset)
+        {
+            holes[kept] = hole;
+            holes[kept++].pos -= keep;
+        }
+    }
+    holes.resize(kept);
+
+    memmove(base, base + keep, live - keep);
+    windowBase = retainOffset;
+    live -= keep;
+    cursorIndex -= keep;
+    dropIndex -= keep;
+
+    // Only trivia worth a hole is dropped, every hole slows WindowOffset() down until it leaves the window
+    if (dropIndex + SCANNER_CHUNK_SIZE / 2 <= cursorIndex)
+    {
+        size_t size = cursorIndex - dropIndex;
+        size_t lines = 0;
+        size_t lastLineStart = 0;
+        CountNewlines(base + dropIndex, base + cursorIndex, lines, lastLineStart);
+
+        if (dropIndex == 0)
+        {
+            // nothing is kept in front of it (no token handed out yet), the window just starts later
+            windowBase += size;
+            retainOffset = windowBase;
+            windowLine += lines;
+            windowLineStart = (lines > 0) ? lastLineStart : windowLineStart;
+        }
+        else if (!holes.empty() && holes.back().pos == dropIndex)
+        {
+            // more of the same trivia
+            holes.back().size += size;
+            holes.back().lines += lines;
+            holes.back().lineStart = (lines > 0) ? lastLineStart : holes.back().lineStart;
+        }
+        else
+        {
+            holes.push_back({dropIndex, WindowOffset(base + dropIndex), size, lines, lastLineStart});
+        }
+
+        memmove(base + dropIndex, base + cursorIndex, live - cursorIndex);
+        live -= size;
+        cursorIndex = dropIndex;
+    }
+
+    // A token that runs past the window is scanned again from its start after every refill, doubling
+    // keeps that linear in the length of the token
+    if (live + SCANNER_CHUNK_SIZE / 2 >= buffer.size())
+    {
+        buffer.resize(max(buffer.size() * 2, live + SCANNER_CHUNK_SIZE));
+    }
+
+    // A pipe hands over at most a few KB per read(), fill the whole window
+    while (live < buffer.size())
+    {
+        ssize_t n;
+        do
+        {
+            n = read(stream->fd, buffer.data() + live, buffer.size() - live);
+        } while (n < 0 && errno == EINTR);
+
+        // a read error ends the input the same way end of stream does
+        if (n <= 0)
+        {
+            stream->eof = true;
+            break;
+        }
+        live += n;
+    }
+
+    source = shared_ptr<const char>(stream, buffer.data());
+    cursor = source.get() + cursorIndex;
+    sourceEnd = source.get() + live;
+
+    // Offsets past SCANNER_MAX_SOURCE would wrap, the input ends there. The cursor is at most at
+    // the end of the previous read, which was still in range.
+    size_t size = WindowOffset(sourceEnd);
+    if (size > SCANNER_MAX_SOURCE)
+    {
+        sourceEnd -= size - SCANNER_MAX_SOURCE;
+        stream->eof = true;
+        stream->tooLarge = true;
+        cout << "Input is too large, the limit is " << SCANNER_MAX_SOURCE << " bytes, the rest is ignored" << endl;
+    }
+    return true;
+}
+
+
+/*
+Method: StreamHasMore()
+Description: True if the input is streamed and there is more of it to read
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+bool Scanner::StreamHasMore()
+{
+    return stream != nullptr && !stream->eof;
+}
+
+
+/*
+Method: ContinueTrivia()
+Description: Whitespace or a comment started at triviaStart ran into the end of the stream window.
+             Reads more input without keeping what was skipped, so the trivia is skipped where it
+             left off instead of scanned again. Returns false if there is nothing more to read.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+bool Scanner::ContinueTrivia(size_t triviaStart)
+{
+    if (!RefillWindow(triviaStart))
+    {
+        return false;
+    }
+
+    hitWindowEnd = false; // the trivia carries on, ScanToken() doesn't have to rescan it
+    return true;
+}
+
+
+/*
+Method: WindowOffset()
+Description: Source offset of a pointer into the window, counting the holes in front of it
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+size_t Scanner::WindowOffset(const char* p)
+{
+    size_t index = p - source.get();
+    size_t offset = windowBase + index;
+    if (holes.empty())
+    {
+        return offset;
+    }
+
+    for (const WindowHole& hole : holes)
+    {
+        if (index < hole.pos)
+        {
+            break;
+        }
+        offset += hole.size;
+    }
+    return offset;
+}
+
+
+/*
+Method: WindowPointer()
+Description: Pointer into the window for a source offset. An offset inside a hole maps to the
+             first byte after it.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+const char* Scanner::WindowPointer(size_t offset)
+{
+    size_t index = offset - windowBase;
+    if (holes.empty())
+    {
+        return source.get() + index;
+    }
+
+    for (const WindowHole& hole : holes)
+    {
+        if (offset < hole.offset)
+        {
+            break;
+        }
+        if (offset < hole.offset + hole.size)
+        {
+            return source.get() + hole.pos;
+        }
+        index -= hole.size;
+    }
+    return source.get() + index;
+}
+
+
 /*
 Method: ScanOneToken()
 Description: Scan tokens one at a time
@@ -136,17 +491,20 @@ Date             Description
 ====================================================================
 21-Jan-2021      Initial
 26-Jan-2021      Modify number literals to handle '_' in numbers
+17-Oct-2026      Token text is a view of the source buffer, nothing is copied into the token
+17-Oct-2026      Skip whitespace, comments, identifiers and numbers with CharClass
 */
-int Scanner::ScanOneToken(FILE* filePtr, token_t* token)
+int Scanner::ScanOneToken(token_t* token)
 {
     char ch, nextCh;
 
+    AdvanceTo(CharClass::SkipSpace(cursor, sourceEnd)); // skip to the first non-space char
+
+    const char* start = cursor;
     ch = ScanNextChar();
 
-    while (isSpace(ch)) // keep reading until non-space char
-    {
-        ch = ScanNextChar();
-    }
+    // token text is a view of the source buffer starting here
+    token->offset = WindowOffset(start);
 
 
     /* I think that technically, we can just eat the comments
@@ -155,198 +513,463 @@ int Scanner::ScanOneToken(FILE* filePtr, token_t* token)
 
     if (ch == '/') // comment or division
     {
-        std::string commentStr = "";
-        commentStr += ch;
         nextCh = ScanNextChar();
 
         if (nextCh == '/') // Single line comment
         {
-            while (nextCh != '\n')
-            {
-                commentStr += nextCh;
-                nextCh = ScanNextChar();
-            }
+            return ScanLineComment();
+        }
+        else if (nextCh == '*') // Block comment and nested block comments
+        {
+            return ScanBlockComment();
+        }
+        else // Division
+        {
+            UndoScan(nextCh);
 
-            token->str = commentStr;
-            for (int i = 0; i < commentStr.length(); i++)
+            return T_DIVIDE;
+        }
+    }
+    else if (isNum(ch)) // number literal
+    {
+        bool isFloatingPoint = false;
+        AdvanceTo(CharClass::SkipDigits(cursor, sourceEnd));
+        nextCh = ScanNextChar();
+
+        if (nextCh == '.')
+        {
+            isFloatingPoint = true;
+            AdvanceTo(CharClass::SkipDigits(cursor, sourceEnd));
+            nextCh = ScanNextChar();
+        }
+
+        UndoScan(nextCh);
+
+        return ConvertNumber(token, start, isFloatingPoint);
+    }
+    else if (ch == '\"') // string literal
+    {
+        nextCh = ScanNextChar();
+
+        while (nextCh != '\"') // just continue until end-quote
+        {
+            if (nextCh == EOF)
             {
-                token->val.stringValue[i] = commentStr[i];
+                // never closed
+                return T_UNKNOWN;
             }
+            nextCh = ScanNextChar();
+        }
+
+        return T_STRING_LITERAL;
+    }
+    else if (isAlpha(ch)) // identifiers
+    {
+        AdvanceTo(CharClass::SkipIdentifier(cursor, sourceEnd));
+
+        return ScanIdentifier(token, start, cursor - start);
+    }
+    else if (isSingleToken(ch)) // tokens/operators
+    {
+        return ScanOperator(ch);
+    }
+    else if (ch == EOF) // end of file
+    {
+        return T_EOF;
+    }
+    else // unknown
+    {
+        return T_UNKNOWN;
+    }
+}
+
+
+/*
+Method: ScanLineComment()
+Description: Skips the rest of a // comment, the cursor is just past the "//"
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, split out of ScanOneToken()
+17-Oct-2026      Carry on into the next chunk of a streamed input
+*/
+int Scanner::ScanLineComment()
+{
+    AdvanceTo(CharClass::FindLineEnd(cursor, sourceEnd));
+    while (cursor == sourceEnd && ContinueTrivia(tokenStart))
+    {
+        AdvanceTo(CharClass::FindLineEnd(cursor, sourceEnd));
+    }
+    ScanNextChar(); // newline is part of the comment
+
+    return T_COMMENT;
+}
 
-            return T_COMMENT;
 
+/*
+Method: ScanBlockComment()
+Description: Skips a (possibly nested) block comment, the cursor is just past the opening delimiter
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, split out of ScanOneToken()
+17-Oct-2026      Carry on into the next chunk of a streamed input
+*/
+int Scanner::ScanBlockComment()
+{
+    char ch, nextCh;
+    int nestedCount = 1;
+
+    while (nestedCount > 0)
+    {
+        // only '*' and '/' can open or close a comment, jump straight to the next one
+        AdvanceTo(CharClass::FindCommentDelimiter(cursor, sourceEnd));
+        const char* delimiter = cursor;
+        ch = ScanNextChar();
+        nextCh = (ch == '*' || ch == '/') ? ScanNextChar() : ch;
+
+        // A streamed comment goes on in the next chunk, look at the delimiter again once it is read
+        // (its second character may be in the new chunk)
+        if (readPastEnd && StreamHasMore())
+        {
+            AdvanceTo(delimiter);
+            ContinueTrivia(tokenStart);
+            continue;
         }
-        else if (nextCh == '*') // Block comment and nested block comments
+
+        if (ch == '*' && nextCh == '/')
+        {
+            nestedCount -= 1;
+        }
+        else if (ch == '/' && nextCh == '*')
         {
-            commentStr += nextCh;
-            int nestedCount = 1;
+            nestedCount += 1;
+        }
+        else if (ch == EOF)
+        {
+            // Not sure about this but if the block comment is never
+            // closed the code just gets stuck in an infinite loop.
+            //
+            return T_UNKNOWN;
+        }
+    }
 
-            while (nestedCount > 0)
-            {
-                nextCh = ScanNextChar();
-                commentStr += nextCh;
-
-                if (nextCh == '*')
-                {
-                    nextCh = ScanNextChar();
-                    commentStr += nextCh;
-                    if (nextCh == '/')
-                    {
-                        nestedCount -= 1;
-                    }
-                }
-                else if (nextCh == '/')
-                {
-                    nextCh = ScanNextChar();
-                    commentStr += nextCh;
-                    if (nextCh == '*')
-                    {
-                        nestedCount += 1;
-                    }
-                }
-                else if (nextCh == EOF)
-                {
-                    // Not sure about this but if the block comment is never
-                    // closed the code just gets stuck in an infinite loop.
-                    //
-                    return T_UNKNOWN;
-                }
-            }
+    return T_COMMENT;
+}
 
-            token->str = commentStr;
-            for (int i = 0; i < commentStr.length(); i++)
-            {
-                token->val.stringValue[i] = commentStr[i];
-            }
 
-            return T_COMMENT;
+// Powers of ten that are exact in a float
+//
+static const float floatPowersOfTen[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+
+/*
+Method: ConvertNumber()
+Description: Converts the number literal [start, cursor) into the token value, reading the digits
+             straight from the source buffer and skipping '_' in the same pass. A literal that
+             doesn't fit in an int (or float) becomes T_UNKNOWN, and the parser reports it.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, split out of ScanOneToken()
+17-Oct-2026      Parse in place instead of building a string for stoi()/stof()
+*/
+int Scanner::ConvertNumber(token_t* token, const char* start, bool isFloatingPoint)
+{
+    uint64_t mantissa = 0;
+    int fractionDigits = 0;
+    bool fraction = false;
+    bool exact = true; // every digit is in mantissa
+
+    for (const char* p = start; p != cursor; p++)
+    {
+        if (*p == '_') // ignore underscores
+        {
+            continue;
+        }
+        if (*p == '.')
+        {
+            fraction = true;
+            continue;
+        }
+        if (mantissa >= UINT64_MAX / 10)
+        {
+            exact = false;
+            break;
+        }
+
+        mantissa = mantissa * 10 + (*p - '0');
+        fractionDigits += fraction;
+    }
+
+    if (!isFloatingPoint)
+    {
+        if (!exact || mantissa > INT_MAX)
+        {
+            return T_UNKNOWN;
         }
-        else // Division
+
+        token->val.intValue = (int)mantissa;
+        return T_INT_LITERAL;
+    }
+
+    // The digits and the power of ten are both exact floats, so one division rounds correctly
+    if (exact && mantissa < (1 << 24) && fractionDigits <= 10)
+    {
+        token->val.floatValue = (float)mantissa / floatPowersOfTen[fractionDigits];
+        return T_FLOAT_LITERAL;
+    }
+
+    return ConvertFloat(token, start);
+}
+
+
+/*
+Method: ConvertFloat()
+Description: Slow path of ConvertNumber() for floats with too many digits to convert exactly by
+             hand, strtof() rounds them correctly. The digits are copied to the stack without
+             the '_', only literals longer than the buffer need the heap.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+int Scanner::ConvertFloat(token_t* token, const char* start)
+{
+    char buffer[64];
+    std::string longNumber;
+    char* number = buffer;
+    if ((size_t)(cursor - start) >= sizeof(buffer))
+    {
+        longNumber.resize(cursor - start + 1);
+        number = &longNumber[0];
+    }
+
+    size_t length = 0;
+    for (const char* p = start; p != cursor; p++)
+    {
+        if (*p != '_')
         {
-            UndoScan(nextCh);
-            token->str = ch;
-            token->val.stringValue[0] = ch;
+            number[length++] = *p;
+        }
+    }
+    number[length] = '\0';
 
-            return T_DIVIDE;
+    // same range check stof() made, but without the exception
+    errno = 0;
+    float value = strtof(number, nullptr);
+    if (errno == ERANGE)
+    {
+        return T_UNKNOWN;
+    }
+
+    token->val.floatValue = value;
+    return T_FLOAT_LITERAL;
+}
+
+
+/*
+Method: LookupReserved()
+Description: Returns the reserved word token for the identifier text, or T_IDENTIFIER.
+             One hash and at most one case-insensitive compare, no allocation.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, replaces the std::map reserved table
+*/
+int Scanner::LookupReserved(const char* text, size_t length)
+{
+    if (length < 2)
+    {
+        return T_IDENTIFIER;
+    }
+
+    unsigned hash = KeywordHash(text, length);
+    if (keywordTable.length[hash] != length)
+    {
+        return T_IDENTIFIER;
+    }
+
+    // reserved words are all upper case letters, & 0xDF upper cases a letter and can't
+    // turn a digit or '_' into one
+    const char* word = keywordTable.word[hash];
+    for (size_t i = 0; i < length; i++)
+    {
+        if ((text[i] & 0xDF) != word[i])
+        {
+            return T_IDENTIFIER;
         }
     }
-    else if (isNum(ch)) // number literal
+
+    return keywordTable.type[hash];
+}
+
+
+/*
+Method: ScanIdentifier()
+Description: Returns the reserved word token for the text, or T_IDENTIFIER with the upper case
+             name interned into token->val.atom
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+int Scanner::ScanIdentifier(token_t* token, const char* text, size_t length)
+{
+    int type = LookupReserved(text, length);
+    if (type == T_IDENTIFIER)
+    {
+        if (foldBuffer.size() < length)
+        {
+            foldBuffer.resize(length);
+        }
+        CharClass::FoldUpper(&foldBuffer[0], text, length);
+        token->val.atom = interner->Intern(foldBuffer.data(), length);
+    }
+    return type;
+}
+
+
+/*
+Method: ScanOperator()
+Description: Returns the operator token starting with ch, scanning the '=' of two character
+             operators
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, replaces the std::map reserved table
+*/
+int Scanner::ScanOperator(char ch)
+{
+    switch (ch)
+    {
+        case ';': return T_SEMICOLON;
+        case '.': return T_PERIOD;
+        case ',': return T_COMMA;
+        case '(': return T_LPAREN;
+        case ')': return T_RPAREN;
+        case '[': return T_LBRACKET;
+        case ']': return T_RBRACKET;
+        case '{': return T_LBRACE;
+        case '}': return T_RBRACE;
+        case '&': return T_AND;
+        case '|': return T_OR;
+        case '+': return T_ADD;
+        case '-': return T_SUBTRACT;
+        case '*': return T_MULTIPLY;
+        default: break;
+    }
+
+    char nextCh = ScanNextChar();
+    bool isEq = (nextCh == '=');
+    if (!isEq)
+    {
+        UndoScan(nextCh);
+    }
+
+    switch (ch)
     {
-        bool isFloatingPoint = false;
-        std::string numberStr = "";
-        numberStr += ch;
-        nextCh = ScanNextChar();
+        case '<': return isEq ? T_LTEQ : T_LESSTHAN;
+        case '>': return isEq ? T_GTEQ : T_GREATERTHAN;
+        case '=': return isEq ? T_EQEQ : T_UNKNOWN;
+        case '!': return isEq ? T_NOTEQ : T_UNKNOWN;
+        case ':': return isEq ? T_ASSIGNMENT : T_COLON;
+        default: return T_UNKNOWN;
+    }
+}
 
-        while (isNum(nextCh) ||
-               (nextCh == '.' && !isFloatingPoint) ||
-               (nextCh == '_'))
+
+/*
+Method: ScanToken()
+Description: Scans the token at the cursor with the selected lexer core, and fills in its
+             length. Comments are trivia, they are skipped (and recorded if
+             SetCollectComments() is on) and never returned as a token.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, split out of FillLookahead()
+17-Oct-2026      Skip comments instead of returning T_COMMENT
+17-Oct-2026      Tokens no longer carry a line and column
+17-Oct-2026      Skip streamed whitespace and comments across refills instead of rescanning them
+*/
+void Scanner::ScanToken(token_t* token)
+{
+    do
+    {
+        size_t scanned = WindowOffset(cursor);
+        tokenStart = scanned;
+        while (true)
         {
-            if (nextCh != '_') // ignore underscores
-            {
-                numberStr += nextCh;
-            }
+            *token = token_t();
+            hitWindowEnd = false;
+            token->type = useDfa ? ScanOneTokenDfa(token) : ScanOneToken(token);
 
-            if (nextCh == '.')
+            // a comment skips on into the next chunk by itself
+            if (!StreamHasMore() || token->type == T_COMMENT || (!hitWindowEnd && cursor != sourceEnd))
             {
-                isFloatingPoint = true;
+                break;
             }
 
-            nextCh = ScanNextChar();
+            // The token may continue past the window, scan it again once more input is read. The
+            // whitespace in front of it is dropped, not skipped again.
+            cursor = WindowPointer(token->offset);
+            RefillWindow(scanned);
         }
 
-        UndoScan(nextCh);
-        token->str = numberStr;
+        size_t end = WindowOffset(cursor);
+        token->length = end - token->offset;
+        bytesScanned += end - scanned;
 
-        if (isFloatingPoint)
-        {
-            token->val.floatValue = stof(numberStr);
-            return T_FLOAT_LITERAL;
-        }
-        else
+        if (token->type == T_COMMENT && comments != nullptr)
         {
-            token->val.intValue = stoi(numberStr);
-            return T_INT_LITERAL;
+            comments->push_back({token->offset, token->length});
         }
-    }
-    else if (ch == '\"') // string literal
-    {
-        std::string stringStr = "";
-        stringStr += ch;
-        nextCh = ScanNextChar();
+    } while (token->type == T_COMMENT);
+}
 
-        int iCh = 0;
-        while (nextCh != '\"') // just continue until end-quote
-        {
-            token->val.stringValue[iCh++] = nextCh;
-            stringStr += nextCh;
-            nextCh = ScanNextChar();
-        }
 
-        stringStr += nextCh;
-        token->str = stringStr;
+/*
+Method: FillLookahead()
+Description: Scans tokens into the lookahead queue until it holds at least k + 1 tokens
 
-        return T_STRING_LITERAL;
-    }
-    else if (isAlpha(ch)) // identifiers
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Select the lexer core
+17-Oct-2026      Rescan tokens that run into the end of a streamed window
+17-Oct-2026      Take tokens from the PreTokenize() array while it lasts
+17-Oct-2026      Take tokens from the lexer thread's ring buffer
+17-Oct-2026      Count the bytes scanning the PreTokenize() tokens consumed
+*/
+void Scanner::FillLookahead(int k)
+{
+    while (lookaheadCount <= k)
     {
-        std::string letterStr = "";
-        int iCh = 0;
-        token->val.stringValue[iCh++] = toupper(ch);
-        letterStr += toupper(ch);
-        nextCh = ScanNextChar();
-        while(isAlpha(nextCh) || isNum(nextCh) || nextCh == '_')
-        {
-            token->val.stringValue[iCh++] = toupper(nextCh);
-            letterStr += toupper(nextCh);
-            nextCh = ScanNextChar();
-        }
-
-        UndoScan(nextCh);
-        token->str = letterStr;
+        token_t* slot = &lookahead[(lookaheadHead + lookaheadCount) % SCANNER_LOOKAHEAD];
 
-        map<string,int>::iterator it;
-        it = reservedTable.find(letterStr);
-        if (it != reservedTable.end()) return reservedTable.find(letterStr)->second;
-        else return T_IDENTIFIER;
-    }
-    else if (isSingleToken(ch)) // tokens/operators
-    {
-        std::string tokenStr = "";
-        int iCh = 0;
-        token->val.stringValue[iCh++] = ch;
-        tokenStr += ch;
+        if (preTokens != nullptr && preTokenIndex < preTokens->size())
+        {
+            bytesScanned += (*preTokenBytes)[preTokenIndex];
+            *slot = (*preTokens)[preTokenIndex++];
 
-        if (ch == '>' || ch == '<' || ch == '=' || ch == '!' || ch == ':')
+            // Scanning picks up from the end of the token once the array runs out
+            cursor = source.get() + slot->offset + slot->length;
+        }
+        else if (pipeline == nullptr || !TakePipelineToken(slot))
         {
-            nextCh = ScanNextChar();
-            if (nextCh == '=')
-            {
-                tokenStr += nextCh;
-                token->val.stringValue[iCh++] = nextCh;
-            }
-            else
-            {
-                UndoScan(nextCh);
-            }
+            ScanToken(slot);
         }
 
-        token->str = tokenStr;
-
-        map<string,int>::iterator it;
-        it = reservedTable.find(tokenStr);
-        if (it != reservedTable.end()) return reservedTable.find(tokenStr)->second;
-        else return T_UNKNOWN;
-    }
-    else if (ch == EOF) // end of file
-    {
-        return T_EOF;
-    }
-    else // unknown
-    {
-        std::string unknownStr = "";
-        unknownStr += ch;
-        token->str = unknownStr;
-        return T_UNKNOWN;
+        lookaheadCount++;
     }
 }
 
@@ -359,19 +982,44 @@ History:
 Date             Description
 ====================================================================
 22-Jan-2021      Initial
+17-Oct-2026      Take the token from the lookahead queue
+17-Oct-2026      Allocate from the token arena
 */
 token_t* Scanner::GetToken()
 {
-    token_t *newToken = new token_t();
+    FillLookahead(0);
 
-    newToken->type = ScanOneToken(filePtr, newToken);
-    newToken->line = lineCount;
-    newToken->col = colCount;
+    token_t *newToken = AllocateToken();
+    *newToken = lookahead[lookaheadHead];
+    lookaheadHead = (lookaheadHead + 1) % SCANNER_LOOKAHEAD;
+    lookaheadCount--;
+    retainOffset = newToken->offset;
 
     return newToken;
 }
 
 
+/*
+Method: AllocateToken()
+Description: Allocates a token to hand out. A streamed input can have any number of tokens, so
+             the arena is recycled once its first block is full instead of growing, a streamed
+             token stays valid for the next TOKEN_ARENA_BLOCK_SIZE tokens handed out.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+token_t* Scanner::AllocateToken()
+{
+    if (stream != nullptr && tokenArena->GetTokenCount() == TOKEN_ARENA_BLOCK_SIZE)
+    {
+        tokenArena->Reset();
+    }
+    return tokenArena->Allocate();
+}
+
+
 /*
 Method: isNum()
 Description: Returns true if input char is a number, false otherwise
@@ -467,72 +1115,370 @@ bool Scanner::isSpace(char c)
 
 /*
 Method: ScanNextChar()
-Description: Gets the next character and handles line/column counts
+Description: Gets the next character
 
 History:
 Date             Description
 ====================================================================
 22-Jan-2021      Initial
+17-Oct-2026      Read from the source buffer instead of the FILE*
+17-Oct-2026      No line/column counts to keep up
 */
 char Scanner::ScanNextChar()
 {
-    char ch = getc(filePtr);
-    int asciiValue = (int)ch;
+    readPastEnd = (cursor == sourceEnd);
+    hitWindowEnd |= readPastEnd;
+    return readPastEnd ? EOF : *cursor++;
+}
 
-    if (ch == '\n')
-    {
-        lineCount++;
-        prevColCount = colCount;
-        colCount = 0;
-    }
 
-    colCount++;
-    return ch;
+/*
+Method: AdvanceTo()
+Description: Moves the cursor forward to p, same as calling ScanNextChar() for every byte
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      No line/column counts to keep up
+*/
+void Scanner::AdvanceTo(const char* p)
+{
+    cursor = p;
 }
 
 
 /*
 Method: UndoScan()
-Description: Un-scans the input character and adjusts counters
+Description: Un-scans the input character
 
 History:
 Date             Description
 ====================================================================
 22-Jan-2021      Initial
+17-Oct-2026      Step the buffer cursor back instead of ungetc()
+17-Oct-2026      Un-scan a 0xFF byte like any other character
+17-Oct-2026      No line/column counts to restore
 */
 void Scanner::UndoScan(char c)
 {
-    if (c == '\n')
+    // The end of the buffer was never consumed, but a 0xFF byte (which also reads as EOF) was
+    if (c != EOF || !readPastEnd)
+    {
+        cursor--;
+    }
+}
+
+/*
+Method: PeekToken()
+Description: Returns the token k positions ahead without consuming it. Tokens are only
+             ever scanned once, repeated peeks return the already queued token.
+
+History:
+Date             Description
+====================================================================
+22-Jan-2021      Initial
+17-Oct-2026      Peek into the lookahead queue instead of rescanning
+17-Oct-2026      Allocate from the token arena
+*/
+token_t* Scanner::PeekToken(int k)
+{
+    if (k < 0 || k >= SCANNER_LOOKAHEAD)
     {
-        lineCount--;
-        colCount = prevColCount;
-        ungetc(c, filePtr);
+        cout << "Error: Cannot peek " << k << " tokens ahead" << endl;
+        k = 0;
+    }
+
+    FillLookahead(k);
+
+    token_t *newToken = AllocateToken();
+    *newToken = lookahead[(lookaheadHead + k) % SCANNER_LOOKAHEAD];
+
+    return newToken;
+}
+
+
+/*
+Method: GetTokenText()
+Description: Returns the text of the token as a view into the source buffer. The view
+             is valid for as long as the scanner (or a copy of it) is alive. When streaming,
+             only the last token from GetToken() and the queued tokens are still in the
+             window, and the view is valid until the next token is scanned.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Offsets are relative to the stream window
+17-Oct-2026      An unclosed streamed comment's text isn't kept, only what is left of it is returned
+*/
+llvm::StringRef Scanner::GetTokenText(const token_t* token)
+{
+    const char* text = WindowPointer(token->offset);
+    return llvm::StringRef(text, min<size_t>(token->length, sourceEnd - text));
+}
+
+
+/*
+Method: GetTokenLocation()
+Description: Line and column of a token for diagnostics. Like the scanner's counters used to,
+             it points just past the end of the token.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void Scanner::GetTokenLocation(const token_t* token, int& line, int& col)
+{
+    GetLocation(token->offset + token->length, line, col);
+}
+
 
+/*
+Method: GetLocation()
+Description: Line and column (both from 1) of a source offset. The first call indexes the start
+             of every line, so only diagnostics pay for line numbers, and only once. A streamed
+             input is no longer in memory, so its lines are counted from the start of the window
+             (RefillWindow() counts the ones that left it), which only works for offsets still
+             in the window.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void Scanner::GetLocation(size_t offset, int& line, int& col)
+{
+    const char* base = source.get();
+    if (stream != nullptr)
+    {
+        size_t lines, lineStart;
+        CountLines(offset, lines, lineStart);
+        line = lines;
+        col = offset - lineStart + 1;
         return;
     }
-    colCount--;
-    ungetc(c, filePtr);
+
+    if (lineStarts == nullptr)
+    {
+        lineStarts = make_shared<vector<uint32_t> >(1, 0);
+        for (const char* q = base; (q = (const char*)memchr(q, '\n', sourceEnd - q)) != nullptr; q++)
+        {
+            lineStarts->push_back(q + 1 - base);
+        }
+    }
+
+    size_t index = upper_bound(lineStarts->begin(), lineStarts->end(), offset) - lineStarts->begin() - 1;
+    line = index + 1;
+    col = offset - (*lineStarts)[index] + 1;
 }
 
-token_t* Scanner::PeekToken()
+
+/*
+Method: CountLines()
+Description: Line number and the source offset its line starts at for an offset in the stream window,
+             counted on from the line the window starts on. The holes carry the lines dropped with them.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial, split out of GetLocation()
+*/
+void Scanner::CountLines(size_t offset, size_t& line, size_t& lineStart)
 {
-    token_t *newToken = new token_t();
+    const char* base = source.get();
+    const char* from = base;
+    line = windowLine;
+    lineStart = windowLineStart;
+
+    for (const WindowHole& hole : holes)
+    {
+        if (offset < hole.offset)
+        {
+            break;
+        }
+
+        CountNewlines(from, base + hole.pos, line, lineStart);
+        from = base + hole.pos;
 
-    // get starting position of the FILE*
-    fpos_t pos;
-    fgetpos(filePtr, &pos);
+        if (offset < hole.offset + hole.size)
+        {
+            return; // inside the dropped trivia, the start of it is as close as it gets
+        }
+        line += hole.lines;
+        lineStart = (hole.lines > 0) ? hole.lineStart : lineStart;
+    }
 
-    int prevLineCount = lineCount;
-    int prevColCount = colCount;
+    CountNewlines(from, min(WindowPointer(offset), sourceEnd), line, lineStart);
+}
 
-    newToken->type = ScanOneToken(filePtr, newToken);
-    newToken->line = lineCount;
-    newToken->col = colCount;
 
-    // reset position
-    fsetpos(filePtr, &pos);
-    lineCount = prevLineCount;
-    colCount = prevColCount;
+/*
+Method: CountNewlines()
+Description: Adds the newlines in [from, to) of the stream window to line, and moves lineStart to the
+             line after the last of them
 
-    return newToken;
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void Scanner::CountNewlines(const char* from, const char* to, size_t& line, size_t& lineStart)
+{
+    const char* last = nullptr;
+    for (const char* q = from; (q = (const char*)memchr(q, '\n', to - q)) != nullptr; q++)
+    {
+        line++;
+        last = q;
+    }
+
+    if (last != nullptr)
+    {
+        lineStart = WindowOffset(last) + 1;
+    }
+}
+
+
+/*
+Method: GetIdentifier()
+Description: Returns the upper case name of an identifier token
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Look the name up by atom
+*/
+const std::string& Scanner::GetIdentifier(const token_t* token)
+{
+    return interner->GetName(token->val.atom);
+}
+
+
+/*
+Method: GetInterner()
+Description: Interner holding the identifier names, atoms in tokens index into it
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+std::shared_ptr<StringInterner> Scanner::GetInterner()
+{
+    return interner;
+}
+
+
+/*
+Method: SetDfaLexer()
+Description: Selects the table driven lexer core (ScanOneTokenDfa()) or the hand written one
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void Scanner::SetDfaLexer(bool enable)
+{
+    useDfa = enable;
+}
+
+
+/*
+Method: GetDfaLexer()
+Description: True if the table driven lexer core is selected
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+bool Scanner::GetDfaLexer()
+{
+    return useDfa;
+}
+
+
+/*
+Method: SetCollectComments()
+Description: Comments are skipped without a trace by default. Turn this on (before scanning) for
+             tooling that wants them, every comment's offset and length is then added to GetComments().
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void Scanner::SetCollectComments(bool enable)
+{
+    comments = enable ? make_shared<vector<trivia_t> >() : nullptr;
+}
+
+
+/*
+Method: GetComments()
+Description: Comments scanned so far, in source order. Empty unless SetCollectComments() is on.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+const std::vector<trivia_t>& Scanner::GetComments()
+{
+    static const vector<trivia_t> none;
+    return (comments != nullptr) ? *comments : none;
+}
+
+
+/*
+Method: GetBytesScanned()
+Description: Total number of source bytes consumed while scanning the tokens handed out, summed
+             token by token in every mode (the PreTokenize() array and the pipeline carry what
+             scanning each token consumed). Once T_EOF is reached this equals GetSourceSize(),
+             i.e. every byte was lexed exactly once, --lex-only checks it.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      A running count with PreTokenize() and the pipeline too
+*/
+size_t Scanner::GetBytesScanned()
+{
+    return bytesScanned;
+}
+
+
+/*
+Method: GetSourceSize()
+Description: Size of the source buffer in bytes, for a streamed input the number of bytes read so far
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Count bytes already dropped from the stream window
+*/
+size_t Scanner::GetSourceSize()
+{
+    return WindowOffset(sourceEnd);
+}
+
+
+/*
+Method: IsSourceTooLarge()
+Description: True if a streamed input went on past SCANNER_MAX_SOURCE and was cut off there (a
+             mapped file that large isn't opened at all)
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+bool Scanner::IsSourceTooLarge()
+{
+    return stream != nullptr && stream->tooLarge;
 }
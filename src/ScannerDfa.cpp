@@ -0,0 +1,344 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      Table driven lexer core, an alternative to the if/else chain in Scanner::ScanOneToken().
+//      Characters are mapped to a class, and the next state is looked up in a transition table
+//      indexed by state and class, until an accepting state is reached. Both tables are built at
+//      compile time. Nested block comments aren't a regular language, so the accepting state for
+//      "/*" hands off to Scanner::ScanBlockComment(), same as the other core.
+//
+
+#include "../include/definitions.h"
+#include "../include/Scanner.h"
+#include "../include/CharClass.h"
+
+#include <algorithm>
+
+// Character classes
+//
+enum
+{
+    CC_OTHER,
+    CC_SPACE,
+    CC_ALPHA,
+    CC_DIGIT,
+    CC_UNDERSCORE,
+    CC_DOT,
+    CC_SLASH,
+    CC_STAR,
+    CC_QUOTE,
+    CC_LT,
+    CC_GT,
+    CC_EQ,
+    CC_BANG,
+    CC_COLON,
+    CC_SEMICOLON,
+    CC_COMMA,
+    CC_LPAREN,
+    CC_RPAREN,
+    CC_LBRACKET,
+    CC_RBRACKET,
+    CC_LBRACE,
+    CC_RBRACE,
+    CC_AND,
+    CC_OR,
+    CC_ADD,
+    CC_SUBTRACT,
+    CC_EOF,         // byte 0xFF (reads as EOF) or the end of the buffer
+    NUM_CLASSES
+};
+
+// States, anything >= DFA_ACCEPT is an accepting state
+//
+enum
+{
+    S_START,
+    S_IDENT,
+    S_INT,
+    S_FLOAT,
+    S_STRING,
+    S_SLASH,
+    S_LT,
+    S_GT,
+    S_EQ,
+    S_BANG,
+    S_COLON,
+    NUM_STATES
+};
+
+#define DFA_ACCEPT 32
+
+enum
+{
+    A_IDENT = DFA_ACCEPT,
+    A_INT,
+    A_FLOAT,
+    A_STRING,
+    A_UNTERMINATED_STRING,
+    A_LINE_COMMENT,
+    A_BLOCK_COMMENT,
+    A_DIVIDE,
+    A_LESSTHAN,
+    A_LTEQ,
+    A_GREATERTHAN,
+    A_GTEQ,
+    A_EQEQ,
+    A_NOTEQ,
+    A_COLON,
+    A_ASSIGNMENT,
+    A_SEMICOLON,
+    A_PERIOD,
+    A_COMMA,
+    A_LPAREN,
+    A_RPAREN,
+    A_LBRACKET,
+    A_RBRACKET,
+    A_LBRACE,
+    A_RBRACE,
+    A_AND,
+    A_OR,
+    A_ADD,
+    A_SUBTRACT,
+    A_MULTIPLY,
+    A_EOF,
+    A_UNKNOWN,          // unknown character, consumed
+    A_UNKNOWN_OPERATOR, // '=' or '!' without a following '=', which is not consumed
+    A_END
+};
+
+#define NUM_ACCEPT (A_END - DFA_ACCEPT)
+
+// What to do once an accepting state is reached
+//
+enum
+{
+    ACT_NONE,
+    ACT_RESERVED,       // identifier, check for a reserved word
+    ACT_NUMBER,         // convert the number literal
+    ACT_LINE_COMMENT,   // skip the rest of the line
+    ACT_BLOCK_COMMENT   // skip the (nested) block comment
+};
+
+struct DfaAccept
+{
+    int type;       // token type
+    bool pushback;  // the character that led here is not part of the token
+    int action;
+};
+
+struct DfaTables
+{
+    unsigned char charClass[256];
+    unsigned char next[NUM_STATES][NUM_CLASSES];
+    DfaAccept accept[NUM_ACCEPT];
+};
+
+static constexpr DfaAccept Accept(int type, bool pushback, int action)
+{
+    return DfaAccept{type, pushback, action};
+}
+
+static constexpr DfaTables GenerateDfaTables()
+{
+    DfaTables tables = {};
+
+    // Character classes, same tests as Scanner::isSpace()/isAlpha()/isNum()
+    for (int c = 0; c < 256; c++)
+    {
+        signed char sc = (signed char)c;
+        unsigned char cc = CC_OTHER;
+
+        if (c == 0xFF) cc = CC_EOF;
+        else if (sc <= 32) cc = CC_SPACE;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) cc = CC_ALPHA;
+        else if (c >= '0' && c <= '9') cc = CC_DIGIT;
+
+        tables.charClass[c] = cc;
+    }
+    tables.charClass[(int)'_'] = CC_UNDERSCORE;
+    tables.charClass[(int)'.'] = CC_DOT;
+    tables.charClass[(int)'/'] = CC_SLASH;
+    tables.charClass[(int)'*'] = CC_STAR;
+    tables.charClass[(int)'"'] = CC_QUOTE;
+    tables.charClass[(int)'<'] = CC_LT;
+    tables.charClass[(int)'>'] = CC_GT;
+    tables.charClass[(int)'='] = CC_EQ;
+    tables.charClass[(int)'!'] = CC_BANG;
+    tables.charClass[(int)':'] = CC_COLON;
+    tables.charClass[(int)';'] = CC_SEMICOLON;
+    tables.charClass[(int)','] = CC_COMMA;
+    tables.charClass[(int)'('] = CC_LPAREN;
+    tables.charClass[(int)')'] = CC_RPAREN;
+    tables.charClass[(int)'['] = CC_LBRACKET;
+    tables.charClass[(int)']'] = CC_RBRACKET;
+    tables.charClass[(int)'{'] = CC_LBRACE;
+    tables.charClass[(int)'}'] = CC_RBRACE;
+    tables.charClass[(int)'&'] = CC_AND;
+    tables.charClass[(int)'|'] = CC_OR;
+    tables.charClass[(int)'+'] = CC_ADD;
+    tables.charClass[(int)'-'] = CC_SUBTRACT;
+
+    // Start state, whitespace has already been skipped
+    for (int cc = 0; cc < NUM_CLASSES; cc++)
+    {
+        tables.next[S_START][cc] = A_UNKNOWN;
+    }
+    tables.next[S_START][CC_ALPHA] = S_IDENT;
+    tables.next[S_START][CC_DIGIT] = S_INT;
+    tables.next[S_START][CC_QUOTE] = S_STRING;
+    tables.next[S_START][CC_SLASH] = S_SLASH;
+    tables.next[S_START][CC_LT] = S_LT;
+    tables.next[S_START][CC_GT] = S_GT;
+    tables.next[S_START][CC_EQ] = S_EQ;
+    tables.next[S_START][CC_BANG] = S_BANG;
+    tables.next[S_START][CC_COLON] = S_COLON;
+    tables.next[S_START][CC_DOT] = A_PERIOD;
+    tables.next[S_START][CC_STAR] = A_MULTIPLY;
+    tables.next[S_START][CC_SEMICOLON] = A_SEMICOLON;
+    tables.next[S_START][CC_COMMA] = A_COMMA;
+    tables.next[S_START][CC_LPAREN] = A_LPAREN;
+    tables.next[S_START][CC_RPAREN] = A_RPAREN;
+    tables.next[S_START][CC_LBRACKET] = A_LBRACKET;
+    tables.next[S_START][CC_RBRACKET] = A_RBRACKET;
+    tables.next[S_START][CC_LBRACE] = A_LBRACE;
+    tables.next[S_START][CC_RBRACE] = A_RBRACE;
+    tables.next[S_START][CC_AND] = A_AND;
+    tables.next[S_START][CC_OR] = A_OR;
+    tables.next[S_START][CC_ADD] = A_ADD;
+    tables.next[S_START][CC_SUBTRACT] = A_SUBTRACT;
+    tables.next[S_START][CC_EOF] = A_EOF;
+
+    // Everything else defaults to accepting on the first character that can't continue the token
+    for (int cc = 0; cc < NUM_CLASSES; cc++)
+    {
+        tables.next[S_IDENT][cc] = A_IDENT;
+        tables.next[S_INT][cc] = A_INT;
+        tables.next[S_FLOAT][cc] = A_FLOAT;
+        tables.next[S_STRING][cc] = S_STRING;
+        tables.next[S_SLASH][cc] = A_DIVIDE;
+        tables.next[S_LT][cc] = A_LESSTHAN;
+        tables.next[S_GT][cc] = A_GREATERTHAN;
+        tables.next[S_EQ][cc] = A_UNKNOWN_OPERATOR;
+        tables.next[S_BANG][cc] = A_UNKNOWN_OPERATOR;
+        tables.next[S_COLON][cc] = A_COLON;
+    }
+
+    tables.next[S_IDENT][CC_ALPHA] = S_IDENT;
+    tables.next[S_IDENT][CC_DIGIT] = S_IDENT;
+    tables.next[S_IDENT][CC_UNDERSCORE] = S_IDENT;
+
+    tables.next[S_INT][CC_DIGIT] = S_INT;
+    tables.next[S_INT][CC_UNDERSCORE] = S_INT;
+    tables.next[S_INT][CC_DOT] = S_FLOAT;
+
+    tables.next[S_FLOAT][CC_DIGIT] = S_FLOAT;
+    tables.next[S_FLOAT][CC_UNDERSCORE] = S_FLOAT;
+
+    tables.next[S_STRING][CC_QUOTE] = A_STRING;
+    tables.next[S_STRING][CC_EOF] = A_UNTERMINATED_STRING;
+
+    tables.next[S_SLASH][CC_SLASH] = A_LINE_COMMENT;
+    tables.next[S_SLASH][CC_STAR] = A_BLOCK_COMMENT;
+
+    tables.next[S_LT][CC_EQ] = A_LTEQ;
+    tables.next[S_GT][CC_EQ] = A_GTEQ;
+    tables.next[S_EQ][CC_EQ] = A_EQEQ;
+    tables.next[S_BANG][CC_EQ] = A_NOTEQ;
+    tables.next[S_COLON][CC_EQ] = A_ASSIGNMENT;
+
+    // Accepting states
+    tables.accept[A_IDENT - DFA_ACCEPT] = Accept(T_IDENTIFIER, true, ACT_RESERVED);
+    tables.accept[A_INT - DFA_ACCEPT] = Accept(T_INT_LITERAL, true, ACT_NUMBER);
+    tables.accept[A_FLOAT - DFA_ACCEPT] = Accept(T_FLOAT_LITERAL, true, ACT_NUMBER);
+    tables.accept[A_STRING - DFA_ACCEPT] = Accept(T_STRING_LITERAL, false, ACT_NONE);
+    tables.accept[A_UNTERMINATED_STRING - DFA_ACCEPT] = Accept(T_UNKNOWN, false, ACT_NONE);
+    tables.accept[A_LINE_COMMENT - DFA_ACCEPT] = Accept(T_COMMENT, false, ACT_LINE_COMMENT);
+    tables.accept[A_BLOCK_COMMENT - DFA_ACCEPT] = Accept(T_COMMENT, false, ACT_BLOCK_COMMENT);
+    tables.accept[A_DIVIDE - DFA_ACCEPT] = Accept(T_DIVIDE, true, ACT_NONE);
+    tables.accept[A_LESSTHAN - DFA_ACCEPT] = Accept(T_LESSTHAN, true, ACT_NONE);
+    tables.accept[A_LTEQ - DFA_ACCEPT] = Accept(T_LTEQ, false, ACT_NONE);
+    tables.accept[A_GREATERTHAN - DFA_ACCEPT] = Accept(T_GREATERTHAN, true, ACT_NONE);
+    tables.accept[A_GTEQ - DFA_ACCEPT] = Accept(T_GTEQ, false, ACT_NONE);
+    tables.accept[A_EQEQ - DFA_ACCEPT] = Accept(T_EQEQ, false, ACT_NONE);
+    tables.accept[A_NOTEQ - DFA_ACCEPT] = Accept(T_NOTEQ, false, ACT_NONE);
+    tables.accept[A_COLON - DFA_ACCEPT] = Accept(T_COLON, true, ACT_NONE);
+    tables.accept[A_ASSIGNMENT - DFA_ACCEPT] = Accept(T_ASSIGNMENT, false, ACT_NONE);
+    tables.accept[A_SEMICOLON - DFA_ACCEPT] = Accept(T_SEMICOLON, false, ACT_NONE);
+    tables.accept[A_PERIOD - DFA_ACCEPT] = Accept(T_PERIOD, false, ACT_NONE);
+    tables.accept[A_COMMA - DFA_ACCEPT] = Accept(T_COMMA, false, ACT_NONE);
+    tables.accept[A_LPAREN - DFA_ACCEPT] = Accept(T_LPAREN, false, ACT_NONE);
+    tables.accept[A_RPAREN - DFA_ACCEPT] = Accept(T_RPAREN, false, ACT_NONE);
+    tables.accept[A_LBRACKET - DFA_ACCEPT] = Accept(T_LBRACKET, false, ACT_NONE);
+    tables.accept[A_RBRACKET - DFA_ACCEPT] = Accept(T_RBRACKET, false, ACT_NONE);
+    tables.accept[A_LBRACE - DFA_ACCEPT] = Accept(T_LBRACE, false, ACT_NONE);
+    tables.accept[A_RBRACE - DFA_ACCEPT] = Accept(T_RBRACE, false, ACT_NONE);
+    tables.accept[A_AND - DFA_ACCEPT] = Accept(T_AND, false, ACT_NONE);
+    tables.accept[A_OR - DFA_ACCEPT] = Accept(T_OR, false, ACT_NONE);
+    tables.accept[A_ADD - DFA_ACCEPT] = Accept(T_ADD, false, ACT_NONE);
+    tables.accept[A_SUBTRACT - DFA_ACCEPT] = Accept(T_SUBTRACT, false, ACT_NONE);
+    tables.accept[A_MULTIPLY - DFA_ACCEPT] = Accept(T_MULTIPLY, false, ACT_NONE);
+    tables.accept[A_EOF - DFA_ACCEPT] = Accept(T_EOF, false, ACT_NONE);
+    tables.accept[A_UNKNOWN - DFA_ACCEPT] = Accept(T_UNKNOWN, false, ACT_NONE);
+    tables.accept[A_UNKNOWN_OPERATOR - DFA_ACCEPT] = Accept(T_UNKNOWN, true, ACT_NONE);
+
+    return tables;
+}
+
+static constexpr DfaTables dfa = GenerateDfaTables();
+static_assert(NUM_STATES <= DFA_ACCEPT, "DFA states overlap the accepting states");
+
+
+/*
+Method: ScanOneTokenDfa()
+Description: Scan one token with the table driven core. Produces the same tokens as ScanOneToken().
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Flag tokens that read up to the end of the stream window
+17-Oct-2026      No line/column counts to keep up
+17-Oct-2026      CC_EOF as an int, like the class table lookup it stands in for
+*/
+int Scanner::ScanOneTokenDfa(token_t* token)
+{
+    AdvanceTo(CharClass::SkipSpace(cursor, sourceEnd)); // skip to the first non-space char
+
+    const char* start = cursor;
+    token->offset = WindowOffset(start);
+
+    // Reading past the end of the buffer gives CC_EOF, same as ScanNextChar() returning EOF
+    size_t size = sourceEnd - start;
+    size_t pos = 0;
+    int state = S_START;
+    while (state < DFA_ACCEPT)
+    {
+        int cc = (pos < size) ? dfa.charClass[(unsigned char)start[pos]] : (int)CC_EOF;
+        state = dfa.next[state][cc];
+        pos++;
+    }
+    hitWindowEnd |= (pos > size);
+
+    const DfaAccept& accept = dfa.accept[state - DFA_ACCEPT];
+    if (accept.pushback)
+    {
+        pos--;
+    }
+
+    AdvanceTo(start + std::min(pos, size));
+
+    switch (accept.action)
+    {
+        case ACT_RESERVED:
+            return ScanIdentifier(token, start, pos);
+        case ACT_NUMBER:
+            return ConvertNumber(token, start, accept.type == T_FLOAT_LITERAL);
+        case ACT_LINE_COMMENT:
+            return ScanLineComment();
+        case ACT_BLOCK_COMMENT:
+            return ScanBlockComment();
+        default:
+            return accept.type;
+    }
+}
@@ -0,0 +1,247 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      Parallel pre-tokenization. The source is split into chunks at newlines and every chunk is
+//      lexed on its own thread, as if it were the start of a file. A chunk can start inside a block
+//      comment or a string literal, so its first few tokens may be wrong. The stitch step re-lexes
+//      from where the previous chunk really ended until it reaches a token the worker also found,
+//      and from there on the worker's tokens are the same ones a single scanner would produce.
+//
+
+#include "../include/definitions.h"
+#include "../include/Scanner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+// Output of one worker
+//
+struct ChunkTokens
+{
+    size_t begin;
+    size_t end;
+    vector<token_t> tokens;
+    vector<uint32_t> bytes; // source bytes scanning each token consumed
+    shared_ptr<StringInterner> interner; // workers intern into their own table, atoms are remapped when stitching
+    shared_ptr<vector<trivia_t> > comments; // null unless collecting comments
+};
+
+
+/*
+Method: LexChunk()
+Description: Lexes the tokens that start in [begin, end) as if begin were the start of the file.
+             The last token may run past end, the last chunk also gets the T_EOF token. bytes gets
+             the source bytes scanning each token consumed, trivia in front of it included.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      No line/column counts to reset
+17-Oct-2026      Record the bytes each token consumed
+*/
+void Scanner::LexChunk(size_t begin, size_t end, bool last, vector<token_t>& tokens, vector<uint32_t>& bytes)
+{
+    cursor = source.get() + begin;
+
+    // rough guess, typical programs average more than 4 bytes per token
+    tokens.reserve((end - begin) / 4 + 1);
+    bytes.reserve(tokens.capacity());
+
+    while (true)
+    {
+        token_t token;
+        size_t scanned = bytesScanned;
+        ScanToken(&token);
+        if (!last && token.offset >= end)
+        {
+            break;
+        }
+
+        tokens.push_back(token);
+        bytes.push_back(bytesScanned - scanned);
+        if (token.type == T_EOF && cursor == sourceEnd)
+        {
+            break;
+        }
+    }
+}
+
+
+/*
+Method: PreTokenize()
+Description: Lexes the whole source on up to threads threads before parsing starts. GetToken() and
+             PeekToken() then take tokens from the merged array, which holds exactly the tokens
+             scanning one at a time would have produced.
+             Must be called right after InitScanner(). A streamed input isn't in memory all at
+             once (and a pipelined one is already being lexed), so it returns false and the tokens
+             are scanned one at a time as usual.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Tokens no longer carry line numbers to rebase
+17-Oct-2026      Not with StartPipeline()
+17-Oct-2026      Keep the bytes scanning each token consumed for GetBytesScanned()
+*/
+bool Scanner::PreTokenize(int threads)
+{
+    if (stream != nullptr || source == nullptr || pipeline != nullptr)
+    {
+        return false;
+    }
+
+    // Chunk boundaries, each one just after a newline
+    const char* base = source.get();
+    size_t size = sourceEnd - base;
+    size_t chunkCount = max<size_t>(1, min<size_t>(max(threads, 1), size / SCANNER_PARALLEL_MIN_CHUNK));
+
+    vector<ChunkTokens> chunks(chunkCount);
+    size_t begin = 0;
+    for (size_t k = 0; k < chunkCount; k++)
+    {
+        size_t end = size;
+        if (k + 1 < chunkCount)
+        {
+            size_t split = max(begin, size / chunkCount * (k + 1));
+            const char* newline = (const char*)memchr(base + split, '\n', size - split);
+            end = (newline != nullptr) ? newline + 1 - base : size;
+        }
+
+        chunks[k].begin = begin;
+        chunks[k].end = end;
+        begin = end;
+    }
+
+    // Lex every chunk, this thread takes the first one
+    auto lex = [this, &chunks, chunkCount](size_t k)
+    {
+        ChunkTokens& chunk = chunks[k];
+        Scanner worker = *this;
+        worker.interner = make_shared<StringInterner>();
+        worker.comments = (comments != nullptr) ? make_shared<vector<trivia_t> >() : nullptr;
+        worker.LexChunk(chunk.begin, chunk.end, k + 1 == chunkCount, chunk.tokens, chunk.bytes);
+        chunk.interner = worker.interner;
+        chunk.comments = worker.comments;
+    };
+
+    vector<thread> workers;
+    for (size_t k = 1; k < chunkCount; k++)
+    {
+        workers.emplace_back(lex, k);
+    }
+    lex(0);
+    for (thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    // Stitch the chunks together
+    auto merged = make_shared<vector<token_t> >();
+    auto mergedBytes = make_shared<vector<uint32_t> >();
+    size_t total = 0;
+    for (const ChunkTokens& chunk : chunks)
+    {
+        total += chunk.tokens.size();
+    }
+    merged->reserve(total + chunkCount);
+    mergedBytes->reserve(total + chunkCount);
+
+    // end of the merged tokens, where a single scanner would be now
+    size_t end = 0;
+    bool reachedEof = false;
+
+    for (size_t k = 0; k < chunkCount && !reachedEof; k++)
+    {
+        ChunkTokens& chunk = chunks[k];
+        vector<token_t>& tokens = chunk.tokens;
+        size_t resync = tokens.size();
+
+        // what scanning the token that lined up consumed from the end of the merged tokens, the
+        // worker started somewhere else
+        uint32_t resyncBytes = 0;
+
+        // Re-lex until a token lines up with one the worker found. Usually the first one does,
+        // unless the chunk started inside a comment or string.
+        size_t j = 0;
+        while (!reachedEof)
+        {
+            cursor = base + end;
+
+            token_t token;
+            size_t scanned = bytesScanned;
+            ScanToken(&token);
+
+            while (j < tokens.size() && tokens[j].offset < token.offset)
+            {
+                j++;
+            }
+            if (j < tokens.size() && tokens[j].offset == token.offset && tokens[j].type == token.type &&
+                tokens[j].length == token.length)
+            {
+                resync = j;
+                resyncBytes = bytesScanned - scanned;
+                break;
+            }
+
+            merged->push_back(token);
+            mergedBytes->push_back(bytesScanned - scanned);
+            end = token.offset + token.length;
+            reachedEof = (token.type == T_EOF && end == size);
+
+            // the rest of this chunk was lexed here
+            if (token.offset >= chunk.end)
+            {
+                break;
+            }
+        }
+
+        // Take the worker's tokens from there on, and the comments between them (the ones in
+        // front of the first one were recorded while re-lexing)
+        if (comments != nullptr && resync < tokens.size())
+        {
+            uint32_t first = tokens[resync].offset;
+            uint32_t last = tokens.back().offset;
+            for (const trivia_t& comment : *chunk.comments)
+            {
+                if (comment.offset > first && comment.offset < last)
+                {
+                    comments->push_back(comment);
+                }
+            }
+        }
+
+        vector<uint32_t> atoms(chunk.interner->GetCount() + 1, ATOM_NONE);
+        for (size_t i = resync; i < tokens.size(); i++)
+        {
+            token_t token = tokens[i];
+            if (token.type == T_IDENTIFIER)
+            {
+                uint32_t& atom = atoms[token.val.atom];
+                if (atom == ATOM_NONE)
+                {
+                    atom = interner->Intern(chunk.interner->GetName(token.val.atom));
+                }
+                token.val.atom = atom;
+            }
+
+            merged->push_back(token);
+            mergedBytes->push_back((i == resync) ? resyncBytes : chunk.bytes[i]);
+            end = token.offset + token.length;
+            reachedEof = (token.type == T_EOF && end == size);
+        }
+    }
+
+    // Anything after the array is scanned one token at a time, see FillLookahead()
+    cursor = base;
+    bytesScanned = 0;
+    preTokens = merged;
+    preTokenIndex = 0;
+    preTokenBytes = mergedBytes;
+    return true;
+}
@@ -0,0 +1,182 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      Pipelined lexing. A copy of the scanner runs on its own thread and pushes tokens into a
+//      single-producer/single-consumer ring buffer, and FillLookahead() takes them from there, so
+//      lexing overlaps with parsing and building the IR. The only thing the two threads share is
+//      the ring and its two indexes, the lexer interns identifiers into its own table and the
+//      parser's side maps those atoms into the real one, same as PreTokenize() does.
+//
+
+#include "../include/definitions.h"
+#include "../include/Scanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+// Ring buffer between the lexer thread and the parser
+//
+struct Scanner::Pipeline
+{
+    token_t ring[SCANNER_PIPELINE_SIZE];
+    uint32_t ringBytes[SCANNER_PIPELINE_SIZE]; // source bytes scanning each token consumed
+    atomic<size_t> head; // next token the parser takes, only the parser writes it
+    char headPadding[64]; // keep the indexes on different cache lines
+    atomic<size_t> tail; // next token the lexer fills, only the lexer writes it
+    char tailPadding[64];
+    atomic<bool> stop; // parser is gone, the lexer quits instead of waiting for room
+    size_t tailSeen; // last tail the parser read, saves touching the lexer's cache line
+    bool finished; // parser has taken the last token
+    vector<uint32_t> atoms; // lexer's atoms to the parser's atoms
+    thread lexer;
+
+    ~Pipeline()
+    {
+        stop = true;
+        if (lexer.joinable())
+        {
+            lexer.join();
+        }
+    }
+};
+
+
+/*
+Method: StartPipeline()
+Description: Starts lexing the source on a separate thread, GetToken() and PeekToken() then take
+             tokens from the ring buffer. Must be called right after InitScanner(). The lexer
+             reads the source while the parser does, so a streamed input (or one already lexed
+             by PreTokenize()) returns false and is scanned one token at a time as usual.
+             Comments are recorded by the lexer thread, GetComments() is only complete once the
+             T_EOF token has been taken.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+bool Scanner::StartPipeline()
+{
+    if (stream != nullptr || source == nullptr || preTokens != nullptr)
+    {
+        return false;
+    }
+
+    auto pipe = make_shared<Pipeline>();
+    pipe->head = 0;
+    pipe->tail = 0;
+    pipe->stop = false;
+    pipe->tailSeen = 0;
+    pipe->finished = false;
+
+    // pipeline is still null in the copy, so the lexer scans tokens itself
+    Scanner lexer = *this;
+    lexer.interner = make_shared<StringInterner>();
+
+    Pipeline* ring = pipe.get();
+    pipe->lexer = thread([lexer, ring]() mutable { lexer.RunPipeline(ring); });
+    pipeline = pipe;
+    return true;
+}
+
+
+/*
+Method: RunPipeline()
+Description: Lexer thread, scans tokens into the ring until the end of the source. Waits while
+             the ring is full, and gives up if the parser is gone.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Pass on the bytes scanning each token consumed
+*/
+void Scanner::RunPipeline(Pipeline* pipe)
+{
+    size_t tail = 0;
+    size_t head = 0;
+    while (true)
+    {
+        while (tail - head == SCANNER_PIPELINE_SIZE)
+        {
+            if (pipe->stop.load(memory_order_relaxed))
+            {
+                return;
+            }
+            this_thread::yield();
+            head = pipe->head.load(memory_order_acquire);
+        }
+
+        token_t* token = &pipe->ring[tail % SCANNER_PIPELINE_SIZE];
+        size_t scanned = bytesScanned;
+        ScanToken(token);
+        pipe->ringBytes[tail % SCANNER_PIPELINE_SIZE] = bytesScanned - scanned;
+        bool last = (token->type == T_EOF && cursor == sourceEnd);
+        pipe->tail.store(++tail, memory_order_release);
+
+        if (last)
+        {
+            return;
+        }
+    }
+}
+
+
+/*
+Method: TakePipelineToken()
+Description: Parser side of the ring, waits for the lexer thread's next token. Returns false once
+             the last token has been taken, scanning picks up from there (at the end of the source).
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+17-Oct-2026      Count the bytes scanning the token consumed
+*/
+bool Scanner::TakePipelineToken(token_t* token)
+{
+    Pipeline* pipe = pipeline.get();
+    if (pipe->finished)
+    {
+        return false;
+    }
+
+    size_t head = pipe->head.load(memory_order_relaxed);
+    while (head == pipe->tailSeen)
+    {
+        pipe->tailSeen = pipe->tail.load(memory_order_acquire);
+        if (head == pipe->tailSeen)
+        {
+            this_thread::yield();
+        }
+    }
+
+    *token = pipe->ring[head % SCANNER_PIPELINE_SIZE];
+    bytesScanned += pipe->ringBytes[head % SCANNER_PIPELINE_SIZE];
+    pipe->head.store(head + 1, memory_order_release);
+
+    // Only the first use of each name is looked up in the real interner
+    if (token->type == T_IDENTIFIER)
+    {
+        if (token->val.atom >= pipe->atoms.size())
+        {
+            pipe->atoms.resize(max<size_t>(token->val.atom + 1, pipe->atoms.size() * 2), ATOM_NONE);
+        }
+
+        uint32_t& atom = pipe->atoms[token->val.atom];
+        if (atom == ATOM_NONE)
+        {
+            ScanIdentifier(token, source.get() + token->offset, token->length);
+            atom = token->val.atom;
+        }
+        token->val.atom = atom;
+    }
+
+    cursor = source.get() + token->offset + token->length;
+    pipe->finished = (token->type == T_EOF && cursor == sourceEnd);
+    return true;
+}
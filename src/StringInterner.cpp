@@ -0,0 +1,157 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#include "../include/StringInterner.h"
+
+#include <cstring>
+
+/* Constructor
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+StringInterner::StringInterner()
+{
+    // atom 0 is ATOM_NONE
+    names.push_back(std::string());
+    hashes.push_back(0);
+    slots.assign(256, ATOM_NONE);
+}
+
+/* Destructor
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+StringInterner::~StringInterner()
+{
+}
+
+
+/*
+Method: Hash()
+Description: FNV-1a hash of the name
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+uint32_t StringInterner::Hash(const char* text, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+/*
+Method: Intern()
+Description: Returns the atom for the name, adding it if it hasn't been seen before
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+uint32_t StringInterner::Intern(const char* text, size_t length)
+{
+    uint32_t hash = Hash(text, length);
+    size_t mask = slots.size() - 1;
+
+    // linear probing
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        uint32_t atom = slots[i];
+        if (atom == ATOM_NONE)
+        {
+            atom = names.size();
+            names.emplace_back(text, length);
+            hashes.push_back(hash);
+            slots[i] = atom;
+
+            // keep the load factor under 1/2
+            if (names.size() * 2 > slots.size())
+            {
+                Grow();
+            }
+            return atom;
+        }
+
+        const std::string& name = names[atom];
+        if (hashes[atom] == hash && name.size() == length && memcmp(name.data(), text, length) == 0)
+        {
+            return atom;
+        }
+    }
+}
+
+uint32_t StringInterner::Intern(const std::string& name)
+{
+    return Intern(name.data(), name.size());
+}
+
+
+/*
+Method: Grow()
+Description: Doubles the hash table and re-inserts every atom
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void StringInterner::Grow()
+{
+    slots.assign(slots.size() * 2, ATOM_NONE);
+    size_t mask = slots.size() - 1;
+
+    for (uint32_t atom = 1; atom < names.size(); atom++)
+    {
+        size_t i = hashes[atom] & mask;
+        while (slots[i] != ATOM_NONE)
+        {
+            i = (i + 1) & mask;
+        }
+        slots[i] = atom;
+    }
+}
+
+
+/*
+Method: GetName()
+Description: Returns the name an atom was interned from
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+const std::string& StringInterner::GetName(uint32_t atom)
+{
+    return names[atom];
+}
+
+
+/*
+Method: GetCount()
+Description: Number of distinct names interned
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+size_t StringInterner::GetCount()
+{
+    return names.size() - 1;
+}
@@ -6,6 +6,7 @@
 
 Symbol::Symbol() {
     id = "";
+    atom = ATOM_NONE;
     arraySize = 0;
     declarationType = T_UNKNOWN;
     type = T_UNKNOWN;
@@ -14,11 +15,6 @@ Symbol::Symbol() {
     isInitialized = false;
     isValid = true;
     isIndexed = false;
-    address = nullptr;
-    value = nullptr;
-    arrayAddress = nullptr;
-    llvmArraySize = nullptr;
-    function = nullptr;
 }
 
 Symbol::~Symbol() {
@@ -33,6 +29,14 @@ void Symbol::SetId(const std::string &id) {
     Symbol::id = id;
 }
 
+uint32_t Symbol::GetAtom() const {
+    return atom;
+}
+
+void Symbol::SetAtom(uint32_t atom) {
+    Symbol::atom = atom;
+}
+
 int Symbol::GetArraySize() const {
     return arraySize;
 }
@@ -101,48 +105,12 @@ std::vector<Symbol> &Symbol::GetParameters() {
     return parameters;
 }
 
-void Symbol::SetParameters(const std::vector<Symbol> &parameters) {
-    Symbol::parameters = parameters;
-}
-
-llvm::Value *Symbol::GetAddress() const {
-    return address;
-}
-
-void Symbol::SetAddress(llvm::Value *address) {
-    Symbol::address = address;
-}
-
-llvm::Value *Symbol::GetValue() const {
-    return value;
-}
-
-void Symbol::SetValue(llvm::Value *value) {
-    Symbol::value = value;
-}
-
-llvm::Value *Symbol::GetArrayAddress() const {
-    return arrayAddress;
-}
-
-void Symbol::SetArrayAddress(llvm::Value *arrayAddress) {
-    Symbol::arrayAddress = arrayAddress;
-}
-
-llvm::Value *Symbol::GetLLVMArraySize() const {
-    return llvmArraySize;
-}
-
-void Symbol::SetLLVMArraySize(llvm::Value *llvmArraySize) {
-    Symbol::llvmArraySize = llvmArraySize;
-}
-
-llvm::Function *Symbol::GetFunction() const {
-    return function;
+const std::vector<Symbol> &Symbol::GetParameters() const {
+    return parameters;
 }
 
-void Symbol::SetFunction(llvm::Function *function) {
-    Symbol::function = function;
+void Symbol::SetParameters(const std::vector<Symbol> &parameters) {
+    Symbol::parameters = parameters;
 }
 
 void Symbol::CopySymbol(Symbol toCopy)
@@ -150,6 +118,7 @@ void Symbol::CopySymbol(Symbol toCopy)
     // I am to lazy to overload the = operator even though this is probably more work
     // actually this might just be a copy constructor...
     this->SetId(toCopy.GetId());
+    this->SetAtom(toCopy.GetAtom());
     this->SetArraySize(toCopy.GetArraySize());
     this->SetDeclarationType(toCopy.GetDeclarationType());
     this->SetType(toCopy.GetType());
@@ -158,10 +127,5 @@ void Symbol::CopySymbol(Symbol toCopy)
     this->SetIsInitialized(toCopy.IsInitialized());
     this->SetIsValid(toCopy.IsValid());
     this->SetIsArrayIndexed(toCopy.IsArrayIndexed());
-    this->SetAddress(toCopy.GetAddress());
-    this->SetArrayAddress(toCopy.GetArrayAddress());
-    this->SetValue(toCopy.GetValue());
-    this->SetLLVMArraySize(toCopy.GetLLVMArraySize());
-    this->SetFunction(toCopy.GetFunction());
     this->SetParameters(toCopy.GetParameters());
 }
\ No newline at end of file
@@ -5,25 +5,50 @@
 #include "../include/definitions.h"
 #include "../include/SymbolTable.h"
 
+#include <algorithm>
+
 
 SymbolTable::SymbolTable()
 {
+    // SYMBOL_NONE
+    symbols.emplace_back();
+    symbols.back().SetIsValid(false);
+
+    slotCount = 0;
     scopeCount = -1;
+    SetInterner(std::make_shared<StringInterner>());
 }
 
 SymbolTable::~SymbolTable()=default;
 
+// Must be the scanner's interner, so atoms in tokens and symbols agree
+void SymbolTable::SetInterner(std::shared_ptr<StringInterner> interner)
+{
+    SymbolTable::interner = interner;
+
+    // identifiers are upper cased and can't start with '_', so these never collide with one
+    procedureAtom = interner->Intern("_procedure");
+    mainAtom = interner->Intern("main");
+}
+
 void SymbolTable::AddScope()
 {
-    localScopes.push_back(std::map<std::string, Symbol>());
+    scopeStarts.push_back(scopeLog.size());
     scopeCount++;
 }
 
 void SymbolTable::RemoveScope()
 {
-    if (localScopes.size() > 0)
+    if (scopeStarts.size() > 0)
     {
-        localScopes.pop_back();
+        // Put back whatever the scope's names shadowed
+        while (scopeLog.size() > scopeStarts.back())
+        {
+            const scope_entry_t &entry = scopeLog.back();
+            FindSlot(entry.atom)->local = entry.shadowed;
+            scopeLog.pop_back();
+        }
+        scopeStarts.pop_back();
     }
     else
     {
@@ -34,39 +59,54 @@ void SymbolTable::RemoveScope()
     scopeCount--;
 }
 
-void SymbolTable::AddSymbol(Symbol &symbol)
+// Stores a new symbol and adds it to the current scope (or the global one), returns its handle
+uint32_t SymbolTable::AddSymbol(const Symbol &symbol)
 {
+    uint32_t handle = NewSymbol(symbol);
+    AddSymbol(handle);
+    return handle;
+}
+
+// Stores a new symbol without adding it to any scope, returns its handle
+uint32_t SymbolTable::NewSymbol(const Symbol &symbol)
+{
+    symbols.push_back(symbol);
+    return symbols.size() - 1;
+}
+
+// Adds a symbol that is already stored to the current scope (or the global one)
+void SymbolTable::AddSymbol(uint32_t handle)
+{
+    const Symbol &symbol = symbols[handle];
     if (symbol.IsGlobal())
     {
-        globalScope[symbol.GetId()] = symbol;
+        GetSlot(symbol.GetAtom()).global = handle;
         return;
     }
 
-    localScopes.back()[symbol.GetId()] = symbol;
+    BindLocal(symbol.GetAtom(), handle);
 }
 
-void SymbolTable::SetScopeProc(Symbol proc)
+// Updates to the symbol are seen by every scope it is in
+Symbol &SymbolTable::GetSymbol(uint32_t handle)
 {
-    localScopes.back()["_procedure"] = proc;
+    return symbols[handle];
 }
 
-Symbol SymbolTable::GetScopeProc()
+void SymbolTable::SetScopeProc(uint32_t handle)
 {
-    if (localScopes.back().find("_procedure") != localScopes.back().end())
-    {
-        return localScopes.back().find("_procedure")->second;
-    }
-    else
-    {
-        Symbol symbol = Symbol();
-        symbol.SetIsValid(false);
-        return symbol;
-    }
+    BindLocal(procedureAtom, handle);
 }
 
-bool SymbolTable::DoesSymbolExist(std::string id)
+uint32_t SymbolTable::GetScopeProc()
 {
-    if (localScopes.back().find(id) != localScopes.back().end())
+    return FindLocal(FindSlot(procedureAtom));
+}
+
+bool SymbolTable::DoesSymbolExist(uint32_t atom)
+{
+    slot_t *slot = FindSlot(atom);
+    if (FindLocal(slot) != SYMBOL_NONE)
     {
         return true;
     }
@@ -75,12 +115,12 @@ bool SymbolTable::DoesSymbolExist(std::string id)
         return false;
     }
 
-    if (globalScope.find(id) != globalScope.end())
+    if (slot != nullptr && slot->global != SYMBOL_NONE)
     {
         return true;
     }
 
-    if (id.compare("main") == 0)
+    if (atom == mainAtom)
     {
         return true;
     }
@@ -88,32 +128,139 @@ bool SymbolTable::DoesSymbolExist(std::string id)
     return false;
 }
 
-Symbol SymbolTable::FindSymbol(std::string id) {
-    std::map<std::string, Symbol>::iterator it = localScopes.back().find(id);
-    if (it != localScopes.back().end())
+uint32_t SymbolTable::FindSymbol(uint32_t atom) {
+    slot_t *slot = FindSlot(atom);
+    if (slot == nullptr)
     {
-        return it->second;
+        return SYMBOL_NONE;
     }
 
-    it = globalScope.find(id);
-    if (it != globalScope.end())
+    uint32_t handle = FindLocal(slot);
+    if (handle != SYMBOL_NONE)
     {
-        return it->second;
+        return handle;
     }
-    Symbol symbol;
-    symbol.SetIsValid(false);;
-    return symbol;
+    return slot->global;
 }
 
-std::map<std::string, Symbol> SymbolTable::GetLocalScope()
+uint32_t SymbolTable::FindSymbol(const std::string &id)
 {
-    return localScopes.back();
+    return FindSymbol(interner->Intern(id));
+}
+
+// Names bound in the current scope, in the order they were added
+llvm::ArrayRef<scope_entry_t> SymbolTable::GetLocalScope()
+{
+    return llvm::makeArrayRef(scopeLog).slice(scopeStarts.back());
+}
+
+// Slot of the atom, or null if it was never added
+SymbolTable::slot_t *SymbolTable::FindSlot(uint32_t atom)
+{
+    if (slots.empty())
+    {
+        return nullptr;
+    }
+
+    size_t mask = slots.size() - 1;
+    for (size_t i = (atom * 2654435769u) & mask; ; i = (i + 1) & mask)
+    {
+        if (slots[i].atom == atom)
+        {
+            return &slots[i];
+        }
+        if (slots[i].atom == ATOM_NONE)
+        {
+            return nullptr;
+        }
+    }
 }
 
-void SymbolTable::AddIOFunctions(llvm::Module *llvmModule, llvm::IRBuilder<> *llvmBuilder)
+// Slot of the atom, added if it isn't there yet
+SymbolTable::slot_t &SymbolTable::GetSlot(uint32_t atom)
+{
+    if ((slotCount + 1) * 2 > slots.size())
+    {
+        Grow();
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = (atom * 2654435769u) & mask;
+    while (slots[i].atom != atom && slots[i].atom != ATOM_NONE)
+    {
+        i = (i + 1) & mask;
+    }
+
+    if (slots[i].atom == ATOM_NONE)
+    {
+        slots[i].atom = atom;
+        slotCount++;
+    }
+    return slots[i];
+}
+
+// Doubles the table and re-inserts every slot in use
+void SymbolTable::Grow()
+{
+    slot_t empty;
+    empty.atom = ATOM_NONE;
+    empty.global = SYMBOL_NONE;
+    empty.local = SCOPE_ENTRY_NONE;
+
+    std::vector<slot_t> old(std::max<size_t>(slots.size() * 2, 64), empty);
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (const slot_t &slot : old)
+    {
+        if (slot.atom == ATOM_NONE)
+        {
+            continue;
+        }
+
+        size_t i = (slot.atom * 2654435769u) & mask;
+        while (slots[i].atom != ATOM_NONE)
+        {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
+
+// Handle bound to the slot's name in the current scope, enclosing scopes aren't visible
+uint32_t SymbolTable::FindLocal(const slot_t *slot)
+{
+    if (slot == nullptr || slot->local == SCOPE_ENTRY_NONE || scopeLog[slot->local].scope != scopeCount)
+    {
+        return SYMBOL_NONE;
+    }
+    return scopeLog[slot->local].handle;
+}
+
+// Binds the atom in the current scope, shadowing any binding from an enclosing one
+void SymbolTable::BindLocal(uint32_t atom, uint32_t handle)
+{
+    slot_t &slot = GetSlot(atom);
+
+    // Rebinding a name in the same scope replaces it
+    if (FindLocal(&slot) != SYMBOL_NONE)
+    {
+        scopeLog[slot.local].handle = handle;
+        return;
+    }
+
+    scope_entry_t entry;
+    entry.atom = atom;
+    entry.handle = handle;
+    entry.scope = scopeCount;
+    entry.shadowed = slot.local;
+    slot.local = scopeLog.size();
+    scopeLog.push_back(entry);
+}
+
+// Adds the runtime's procedures to the global scope, CodeGen declares them in the module
+void SymbolTable::AddIOFunctions()
 {
-    llvm::FunctionType *type = nullptr;
-    llvm::Function *procedure = nullptr;
     Symbol args;
 
     // putInteger
@@ -121,67 +268,66 @@ void SymbolTable::AddIOFunctions(llvm::Module *llvmModule, llvm::IRBuilder<> *ll
     args.SetId("num");
     args.SetType(T_INTEGER);
     args.SetDeclarationType(T_VARIABLE);
-    Symbol putInt = GeneratePutSymbol("PUTINTEGER", T_BOOL, args, llvmModule, llvmBuilder,{llvmBuilder->getInt32Ty()});
-    AddSymbol(putInt);
+    Symbol putInt = GeneratePutSymbol("PUTINTEGER", T_BOOL, args);
+    ioFunctions.push_back(AddSymbol(putInt));
 
     // getInteger
-    Symbol getInt = GenerateGetSymbol("GETINTEGER", T_INTEGER, llvmModule, llvmBuilder, llvmBuilder->getInt32Ty());
-    AddSymbol(getInt);
+    Symbol getInt = GenerateGetSymbol("GETINTEGER", T_INTEGER);
+    ioFunctions.push_back(AddSymbol(getInt));
 
     // putFloat
     args = Symbol();
     args.SetId("num");
     args.SetType(T_FLOAT);
     args.SetDeclarationType(T_VARIABLE);
-    Symbol putFloat = GeneratePutSymbol("PUTFLOAT", T_BOOL, args, llvmModule, llvmBuilder, {llvmBuilder->getFloatTy()});
-    AddSymbol(putFloat);
+    Symbol putFloat = GeneratePutSymbol("PUTFLOAT", T_BOOL, args);
+    ioFunctions.push_back(AddSymbol(putFloat));
 
     // getFloat
-    Symbol getFloat = GenerateGetSymbol("GETFLOAT", T_FLOAT, llvmModule, llvmBuilder, llvmBuilder->getFloatTy());
-    AddSymbol(getFloat);
+    Symbol getFloat = GenerateGetSymbol("GETFLOAT", T_FLOAT);
+    ioFunctions.push_back(AddSymbol(getFloat));
 
     // putBool
     args = Symbol();
     args.SetId("num");
     args.SetType(T_BOOL);
     args.SetDeclarationType(T_VARIABLE);
-    Symbol putBool = GeneratePutSymbol("PUTBOOL", T_BOOL, args, llvmModule, llvmBuilder, {llvmBuilder->getInt1Ty()});
-    AddSymbol(putBool);
+    Symbol putBool = GeneratePutSymbol("PUTBOOL", T_BOOL, args);
+    ioFunctions.push_back(AddSymbol(putBool));
 
     // getBool
-    Symbol getBool = GenerateGetSymbol("GETBOOL", T_BOOL, llvmModule, llvmBuilder, llvmBuilder->getInt1Ty());
-    AddSymbol(getBool);
+    Symbol getBool = GenerateGetSymbol("GETBOOL", T_BOOL);
+    ioFunctions.push_back(AddSymbol(getBool));
 
     // putString
     args = Symbol();
     args.SetId("str");
     args.SetType(T_STRING);
     args.SetDeclarationType(T_VARIABLE);
-    Symbol putString = GeneratePutSymbol("PUTSTRING", T_BOOL, args, llvmModule, llvmBuilder, {llvmBuilder->getInt8PtrTy()});
-    AddSymbol(putString);
+    Symbol putString = GeneratePutSymbol("PUTSTRING", T_BOOL, args);
+    ioFunctions.push_back(AddSymbol(putString));
 
     // getString
-    Symbol getString = GenerateGetSymbol("GETSTRING", T_STRING, llvmModule, llvmBuilder, llvmBuilder->getInt8PtrTy());
-    AddSymbol(getString);
+    Symbol getString = GenerateGetSymbol("GETSTRING", T_STRING);
+    ioFunctions.push_back(AddSymbol(getString));
 
     // sqrt
     args = Symbol();
     args.SetId("num");
     args.SetType(T_INTEGER);
     args.SetDeclarationType(T_VARIABLE);
-    Symbol sqrt = GeneratePutSymbol("SQRT", T_FLOAT, args, llvmModule, llvmBuilder, {llvmBuilder->getInt32Ty()});
-    AddSymbol(sqrt);
+    Symbol sqrt = GeneratePutSymbol("SQRT", T_FLOAT, args);
+    ioFunctions.push_back(AddSymbol(sqrt));
+
+    // Array out-of-bounds error (returns nothing, see CodeGen::AddIOFunctions())
+    Symbol oobError = GenerateGetSymbol("OOB_ERROR", T_BOOL);
+    ioFunctions.push_back(AddSymbol(oobError));
+}
 
-    // Array out-of-bounds error
-    Symbol oobError;
-    oobError.SetId("OOB_ERROR");
-    oobError.SetType(T_BOOL);
-    oobError.SetIsGlobal(true);
-    oobError.SetDeclarationType(T_PROCEDURE);
-    type = llvm::FunctionType::get(llvmBuilder->getVoidTy(), {}, false);
-    procedure = llvm::Function::Create(type, llvm::Function::ExternalLinkage, oobError.GetId(), llvmModule);
-    oobError.SetFunction(procedure);
-    AddSymbol(oobError);
+// Handles of the runtime's procedures, in the order they were added
+llvm::ArrayRef<uint32_t> SymbolTable::GetIOFunctions()
+{
+    return ioFunctions;
 }
 
 int SymbolTable::GetScopeCount()
@@ -189,44 +335,28 @@ int SymbolTable::GetScopeCount()
     return scopeCount;
 }
 
-Symbol SymbolTable::GeneratePutSymbol(std::string id, int type, Symbol args, llvm::Module *llvmModule,
-                                      llvm::IRBuilder<> *llvmBuilder, llvm::ArrayRef<llvm::Type *> llvmArgType)
+Symbol SymbolTable::GeneratePutSymbol(std::string id, int type, Symbol args)
 {
-    llvm::FunctionType *llvmType = nullptr;
-
     Symbol put;
     put.SetId(id);
+    put.SetAtom(interner->Intern(id));
     put.SetType(type);
 
     put.GetParameters().push_back(args);
     put.SetIsGlobal(true);
     put.SetDeclarationType(T_PROCEDURE);
 
-    if (id == "SQRT")
-    {
-        llvmType = llvm::FunctionType::get(llvmBuilder->getFloatTy(), llvmArgType, false);
-    }
-    else
-    {
-        llvmType = llvm::FunctionType::get(llvmBuilder->getInt1Ty(), llvmArgType, false);
-    }
-    llvm::Function *procedure = llvm::Function::Create(llvmType, llvm::Function::ExternalLinkage, put.GetId(), llvmModule);
-    put.SetFunction(procedure);
-
     return put;
 }
 
-Symbol SymbolTable::GenerateGetSymbol(std::string id, int type, llvm::Module *llvmModule,
-                                      llvm::IRBuilder<> *llvmBuilder, llvm::Type *llvmTy)
+Symbol SymbolTable::GenerateGetSymbol(std::string id, int type)
 {
     Symbol get;
     get.SetId(id);
+    get.SetAtom(interner->Intern(id));
     get.SetType(type);
     get.SetIsGlobal(true);
     get.SetDeclarationType(T_PROCEDURE);
-    llvm::FunctionType *llvmType = llvm::FunctionType::get(llvmTy, {},false);
-    llvm::Function *procedure = llvm::Function::Create(llvmType, llvm::Function::ExternalLinkage, get.GetId(), llvmModule);
-    get.SetFunction(procedure);
 
     return get;
-}
\ No newline at end of file
+}
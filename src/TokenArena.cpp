@@ -0,0 +1,97 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+
+#include "../include/TokenArena.h"
+
+/* Constructor
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+TokenArena::TokenArena()
+{
+    blockIndex = 0;
+    blockUsed = 0;
+}
+
+/* Destructor
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+TokenArena::~TokenArena()
+{
+}
+
+
+/*
+Method: Allocate()
+Description: Returns a token from the current block, starting a new block when it is full.
+             Tokens stay valid until Reset() is called.
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+token_t* TokenArena::Allocate()
+{
+    if (blocks.empty() || blockUsed == TOKEN_ARENA_BLOCK_SIZE)
+    {
+        if (!blocks.empty())
+        {
+            blockIndex++;
+        }
+
+        // Blocks are kept across Reset(), only grow when we run out
+        if (blockIndex == blocks.size())
+        {
+            blocks.emplace_back(new token_t[TOKEN_ARENA_BLOCK_SIZE]);
+        }
+
+        blockUsed = 0;
+    }
+
+    return &blocks[blockIndex][blockUsed++];
+}
+
+
+/*
+Method: Reset()
+Description: Releases every token at once so the blocks can be reused by the next compilation
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+void TokenArena::Reset()
+{
+    blockIndex = 0;
+    blockUsed = 0;
+}
+
+
+/*
+Method: GetTokenCount()
+Description: Number of tokens allocated since the last Reset()
+
+History:
+Date             Description
+====================================================================
+17-Oct-2026      Initial
+*/
+size_t TokenArena::GetTokenCount()
+{
+    if (blocks.empty())
+    {
+        return 0;
+    }
+
+    return blockIndex * TOKEN_ARENA_BLOCK_SIZE + blockUsed;
+}
@@ -0,0 +1,170 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      make test-simd. Runs every CharClass routine at each SIMD level the CPU has against its
+//      scalar version, on every buffer length up to a few vectors and on longer random ones, from
+//      every alignment. The buffers end right before an unmapped page, so a vector load past the
+//      end faults instead of reading garbage. Bytes are drawn from the ones the routines treat
+//      differently (space, letters, digits, '_', '\n', '*', '/', 0x80 and up, 0xFF) with long runs
+//      of one of them, so the vector loops see whole blocks that continue a run as well as ones
+//      that end it at every position.
+//
+
+#include "../../include/CharClass.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Buffers checked at each level
+//
+#define TEST_EDGE_LENGTH 160      // every length up to this, from every alignment up to TEST_MAX_ALIGN
+#define TEST_MAX_ALIGN 32
+#define TEST_RANDOM_BUFFERS 2000  // and this many more up to TEST_MAX_LENGTH long
+#define TEST_MAX_LENGTH 4096
+#define TEST_MAX_FAILURES 10      // reported before giving up
+
+typedef const char* (*skip_t)(const char*, const char*);
+
+struct routine_t
+{
+    const char* name;
+    skip_t dispatched;
+    skip_t scalar;
+};
+
+static const routine_t routines[] =
+{
+    {"SkipSpace", CharClass::SkipSpace, CharClass::SkipSpaceScalar},
+    {"SkipIdentifier", CharClass::SkipIdentifier, CharClass::SkipIdentifierScalar},
+    {"SkipDigits", CharClass::SkipDigits, CharClass::SkipDigitsScalar},
+    {"FindLineEnd", CharClass::FindLineEnd, CharClass::FindLineEndScalar},
+    {"FindCommentDelimiter", CharClass::FindCommentDelimiter, CharClass::FindCommentDelimiterScalar},
+};
+
+// Bytes on either side of a class boundary for some routine
+static const unsigned char interesting[] =
+{
+    ' ', '\t', '\n', '\r', 0x00, 0x20, 0x21, 'a', 'z', 'A', 'Z', 'g', '0', '9', '_',
+    '*', '/', '@', '`', '[', '{', 0x7F, 0x80, 0xC3, 0xFE, 0xFF
+};
+
+static mt19937 rng(17102026);
+static int failures = 0;
+
+// length bytes that end where the guard page starts
+static char* guardedEnd;
+
+static char* FillBuffer(size_t length)
+{
+    char* buffer = guardedEnd - length;
+
+    // mostly one byte, broken up by others more or less often
+    unsigned char run = interesting[rng() % sizeof(interesting)];
+    unsigned int breakOdds = 1u << (rng() % 8);
+    for (size_t i = 0; i < length; i++)
+    {
+        buffer[i] = (rng() % breakOdds == 0) ? interesting[rng() % sizeof(interesting)] : run;
+    }
+    return buffer;
+}
+
+// Counts a mismatch, true while there are few enough to print
+static bool Fail()
+{
+    return ++failures <= TEST_MAX_FAILURES;
+}
+
+// Every routine on [buffer + align, buffer + length)
+static void CheckBuffer(const char* buffer, size_t length, size_t align, const char* level)
+{
+    const char* p = buffer + align;
+    const char* end = buffer + length;
+    for (const routine_t& routine : routines)
+    {
+        const char* got = routine.dispatched(p, end);
+        const char* expected = routine.scalar(p, end);
+        if (got != expected && Fail())
+        {
+            printf("%s at %s: length %zu from %zu stops at %ld, the scalar version at %ld\n", routine.name, level,
+                   length, align, (long)(got - p), (long)(expected - p));
+        }
+    }
+
+    // FoldUpper writes exactly the bytes asked for, guards on both sides have to survive
+    size_t count = length - align;
+    vector<char> got(count + 2 * TEST_MAX_ALIGN, (char)0xA5);
+    vector<char> expected(got);
+    CharClass::FoldUpper(got.data() + TEST_MAX_ALIGN, p, count);
+    CharClass::FoldUpperScalar(expected.data() + TEST_MAX_ALIGN, p, count);
+    if (got != expected && Fail())
+    {
+        size_t i = 0;
+        while (got[i] == expected[i])
+        {
+            i++;
+        }
+        printf("FoldUpper at %s: length %zu from %zu differs from the scalar version at %ld\n", level, length, align,
+               (long)i - TEST_MAX_ALIGN);
+    }
+}
+
+int main()
+{
+    // two pages, the second one can't be read
+    long page = sysconf(_SC_PAGESIZE);
+    size_t mapped = (TEST_MAX_LENGTH / page + 2) * page;
+    char* memory = (char*)mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED || mprotect(memory + mapped - page, page, PROT_NONE) != 0)
+    {
+        printf("Could not map the test buffers\n");
+        return 1;
+    }
+    guardedEnd = memory + mapped - page;
+
+    const char* levels[] = {"scalar", "sse2", "avx2"};
+    for (int level = SIMD_SCALAR; level <= SIMD_AVX2; level++)
+    {
+        CharClass::SetSimdLevel(level);
+        if (CharClass::GetSimdLevel() != level)
+        {
+            printf("%s: not supported by this CPU, skipped\n", levels[level]);
+            continue;
+        }
+
+        size_t checked = 0;
+        for (size_t length = 0; length <= TEST_EDGE_LENGTH; length++)
+        {
+            for (size_t align = 0; align <= TEST_MAX_ALIGN && align <= length; align++)
+            {
+                CheckBuffer(FillBuffer(length), length, align, levels[level]);
+                checked++;
+            }
+        }
+
+        for (int i = 0; i < TEST_RANDOM_BUFFERS; i++)
+        {
+            size_t length = rng() % (TEST_MAX_LENGTH + 1);
+            size_t align = rng() % (min<size_t>(length, TEST_MAX_ALIGN) + 1);
+            CheckBuffer(FillBuffer(length), length, align, levels[level]);
+            checked++;
+        }
+
+        printf("%s: %zu buffers checked\n", levels[level], checked);
+    }
+
+    munmap(memory, mapped);
+    if (failures > 0)
+    {
+        printf("%d mismatches with the scalar versions\n", failures);
+        return 1;
+    }
+    return 0;
+}
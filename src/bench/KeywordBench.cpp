@@ -0,0 +1,125 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      make bench-keywords. Classifies every word of a source file as a reserved word or an
+//      identifier, over and over, with the perfect hash the scanner uses (Scanner::LookupReserved())
+//      and with the std::map<std::string, int> of upper case words it replaced, and reports the
+//      time per lookup of each. Both have to agree on every word.
+//
+
+#include "../../include/definitions.h"
+#include "../../include/Scanner.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Lookups timed for each table, the words of the file are repeated to get there
+//
+#define BENCH_LOOKUPS 20000000
+
+struct word_t
+{
+    const char* text;
+    size_t length;
+};
+
+// The reserved table before the perfect hash, filled in InitScanner()
+static map<string, int> BuildReservedMap()
+{
+    map<string, int> reserved;
+#define RESERVED_WORD_ENTRY(word, type) reserved[word] = type;
+    RESERVED_WORDS(RESERVED_WORD_ENTRY)
+#undef RESERVED_WORD_ENTRY
+    return reserved;
+}
+
+// ... and the lookup, the identifier is upper cased into a string first
+static int LookupReservedMap(const map<string, int>& reserved, const char* text, size_t length)
+{
+    string upper(text, length);
+    for (char& ch : upper)
+    {
+        ch = toupper(ch);
+    }
+
+    auto it = reserved.find(upper);
+    return (it != reserved.end()) ? it->second : T_IDENTIFIER;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        printf("usage: %s <file_name>\n", argv[0]);
+        return 1;
+    }
+
+    ifstream file(argv[1], ios::binary);
+    string source((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    // the identifiers and reserved words, as the scanner would see them
+    vector<word_t> words;
+    for (size_t i = 0; i < source.size(); )
+    {
+        if (!isalpha((unsigned char)source[i]))
+        {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < source.size() && (isalnum((unsigned char)source[i]) || source[i] == '_'))
+        {
+            i++;
+        }
+        words.push_back({source.data() + start, i - start});
+    }
+
+    if (words.empty())
+    {
+        printf("%s: no words to look up\n", argv[1]);
+        return 1;
+    }
+
+    map<string, int> reserved = BuildReservedMap();
+    for (const word_t& word : words)
+    {
+        if (Scanner::LookupReserved(word.text, word.length) != LookupReservedMap(reserved, word.text, word.length))
+        {
+            printf("%.*s: the perfect hash and the map disagree\n", (int)word.length, word.text);
+            return 1;
+        }
+    }
+
+    // the sum of the token types keeps the lookups from being optimized away
+    long sum = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        const word_t& word = words[i % words.size()];
+        sum += LookupReservedMap(reserved, word.text, word.length);
+    }
+    double mapSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        const word_t& word = words[i % words.size()];
+        sum -= Scanner::LookupReserved(word.text, word.length);
+    }
+    double hashSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    printf("%s: %zu words, %d lookups each (checksum %ld)\n", argv[1], words.size(), BENCH_LOOKUPS, sum);
+    printf("  std::map + upper case string  %6.2f ns/lookup\n", mapSeconds * 1e9 / BENCH_LOOKUPS);
+    printf("  perfect hash                  %6.2f ns/lookup\n", hashSeconds * 1e9 / BENCH_LOOKUPS);
+    return 0;
+}
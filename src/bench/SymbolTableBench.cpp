@@ -0,0 +1,159 @@
+//
+// Created by Nick Clason on 10/17/26.
+//
+// Description:
+//      make bench-symbols. Binds globals, then opens procedure scopes one after the other, each
+//      binding its locals, looking names up and iterating its locals before it is removed, the
+//      way the parser uses the symbol table. Timed with the SymbolTable (one open addressing table
+//      and a scope log) and with the std::map per scope it replaced, both have to find the same
+//      symbols.
+//
+
+#include "../../include/SymbolTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Shape of the program the tables are run through
+//
+#define BENCH_GLOBALS 20000
+#define BENCH_SCOPES 20000
+#define BENCH_LOCALS 16           // bound in each scope
+#define BENCH_LOOKUPS 100         // in each scope, locals and globals alternating
+
+// The scopes before the SymbolTable used one table, a map for the globals and one per local scope
+class MapScopes
+{
+public:
+    void AddScope()
+    {
+        localScopes.emplace_back();
+    }
+
+    void RemoveScope()
+    {
+        localScopes.pop_back();
+    }
+
+    void AddSymbol(uint32_t atom, uint32_t handle, bool isGlobal)
+    {
+        (isGlobal ? globalScope : localScopes.back())[atom] = handle;
+    }
+
+    uint32_t FindSymbol(uint32_t atom)
+    {
+        auto it = localScopes.back().find(atom);
+        if (it != localScopes.back().end())
+        {
+            return it->second;
+        }
+
+        it = globalScope.find(atom);
+        return (it != globalScope.end()) ? it->second : SYMBOL_NONE;
+    }
+
+    const map<uint32_t, uint32_t> &GetLocalScope()
+    {
+        return localScopes.back();
+    }
+
+private:
+    map<uint32_t, uint32_t> globalScope;
+    vector<map<uint32_t, uint32_t> > localScopes;
+};
+
+int main()
+{
+    SymbolTable symbolTable;
+    auto interner = make_shared<StringInterner>();
+    symbolTable.SetInterner(interner);
+
+    // the symbols are stored up front, only binding and finding them is timed
+    vector<uint32_t> globals, locals;
+    vector<uint32_t> globalAtoms, localAtoms;
+    for (int i = 0; i < BENCH_GLOBALS + BENCH_LOCALS; i++)
+    {
+        bool isGlobal = i < BENCH_GLOBALS;
+        Symbol symbol;
+        symbol.SetId((isGlobal ? "G" : "L") + to_string(i));
+        symbol.SetAtom(interner->Intern(symbol.GetId()));
+        symbol.SetIsGlobal(isGlobal);
+        symbol.SetType(T_INTEGER);
+
+        (isGlobal ? globals : locals).push_back(symbolTable.NewSymbol(symbol));
+        (isGlobal ? globalAtoms : localAtoms).push_back(symbol.GetAtom());
+    }
+
+    // the sum of the handles found keeps the lookups from being optimized away, and has to match
+    long tableSum = 0;
+    auto start = chrono::steady_clock::now();
+    symbolTable.AddScope();
+    for (uint32_t handle : globals)
+    {
+        symbolTable.AddSymbol(handle);
+    }
+    for (int scope = 0; scope < BENCH_SCOPES; scope++)
+    {
+        symbolTable.AddScope();
+        for (uint32_t handle : locals)
+        {
+            symbolTable.AddSymbol(handle);
+        }
+        for (int i = 0; i < BENCH_LOOKUPS; i++)
+        {
+            uint32_t atom = (i & 1) ? globalAtoms[(scope * BENCH_LOOKUPS + i) % BENCH_GLOBALS] : localAtoms[i % BENCH_LOCALS];
+            tableSum += symbolTable.FindSymbol(atom);
+        }
+        for (const scope_entry_t &entry : symbolTable.GetLocalScope())
+        {
+            tableSum += entry.handle;
+        }
+        symbolTable.RemoveScope();
+    }
+    double tableSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long mapSum = 0;
+    start = chrono::steady_clock::now();
+    MapScopes mapScopes;
+    mapScopes.AddScope();
+    for (int i = 0; i < BENCH_GLOBALS; i++)
+    {
+        mapScopes.AddSymbol(globalAtoms[i], globals[i], true);
+    }
+    for (int scope = 0; scope < BENCH_SCOPES; scope++)
+    {
+        mapScopes.AddScope();
+        for (int i = 0; i < BENCH_LOCALS; i++)
+        {
+            mapScopes.AddSymbol(localAtoms[i], locals[i], false);
+        }
+        for (int i = 0; i < BENCH_LOOKUPS; i++)
+        {
+            uint32_t atom = (i & 1) ? globalAtoms[(scope * BENCH_LOOKUPS + i) % BENCH_GLOBALS] : localAtoms[i % BENCH_LOCALS];
+            mapSum += mapScopes.FindSymbol(atom);
+        }
+        for (const auto &entry : mapScopes.GetLocalScope())
+        {
+            mapSum += entry.second;
+        }
+        mapScopes.RemoveScope();
+    }
+    double mapSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (tableSum != mapSum)
+    {
+        printf("The SymbolTable and the maps found different symbols\n");
+        return 1;
+    }
+
+    printf("%d globals, %d scopes of %d locals with %d lookups each\n", BENCH_GLOBALS, BENCH_SCOPES, BENCH_LOCALS,
+           BENCH_LOOKUPS);
+    printf("  std::map per scope   %7.2f ms\n", mapSeconds * 1000.0);
+    printf("  flat table + log     %7.2f ms\n", tableSeconds * 1000.0);
+    return 0;
+}
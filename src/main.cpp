@@ -4,9 +4,62 @@
 
 #include "../include/definitions.h"
 #include "../include/Parser.h"
+#include "../include/CharClass.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 
+#include <sys/resource.h>
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
+#ifdef COUNT_ALLOCATIONS
+// Count every heap allocation, so --lex-only can report allocations per token. Only in a
+// make COUNT_ALLOCATIONS=1 build, the count costs every allocation in the compiler an atomic increment.
+//
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+    {
+        abort();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+#endif
+
 std::string GetFileName()
 {
     std::string fileName;
@@ -16,62 +69,388 @@ std::string GetFileName()
     return fileName;
 }
 
-void ScannerTest(std::string fileName)
+// Print every token in the file
+void ScannerTest(Scanner &s)
 {
-    Scanner* s = new Scanner();
-    s->InitScanner(fileName);
+    token_t* token = nullptr;
+    do
+    {
+        token = s.GetToken();
+        int line, col;
+        s.GetTokenLocation(token, line, col);
+        std::cout << "<" << token->type << ", " << s.GetTokenText(token).str() << ">, Line: " << line << " Col: " << col << std::endl;
+    } while (token->type != T_EOF);
+}
+
+// Print the comments the scanner recorded since the last call, printed counts them. Like a token,
+// a comment's location is just past its end.
+void DumpComments(Scanner &s, size_t &printed)
+{
+    const std::vector<trivia_t> &comments = s.GetComments();
+    for (; printed < comments.size(); printed++)
+    {
+        token_t comment = {};
+        comment.type = T_COMMENT;
+        comment.offset = comments[printed].offset;
+        comment.length = comments[printed].length;
+
+        int line, col;
+        s.GetTokenLocation(&comment, line, col);
+        std::cout << "<comment>, Offset: " << comment.offset << " Length: " << comment.length << ", Line: " << line << " Col: " << col << std::endl;
+    }
+}
+
+// Lex the file without parsing it and report scanner throughput. Every byte of the source has to
+// have been scanned exactly once by the time T_EOF comes out.
+bool LexOnly(std::string fileName, std::string lexer, int threads, bool pipeline, bool dumpTokens, bool dumpComments)
+{
+#ifdef COUNT_ALLOCATIONS
+    size_t allocationsBefore = allocationCount;
+#endif
+    auto start = std::chrono::steady_clock::now();
+
+    Scanner s;
+    if (!lexer.empty())
+    {
+        s.SetDfaLexer(lexer == "dfa");
+    }
+    s.SetCollectComments(dumpComments);
+    if (!s.InitScanner(fileName))
+    {
+        return false;
+    }
+    if (threads > 0)
+    {
+        s.PreTokenize(threads);
+    }
+    else if (pipeline)
+    {
+        pipeline = s.StartPipeline();
+    }
 
-    token_t* token = new token_t();
+    // A streamed comment is only in the window for a while, so they are printed as they are
+    // scanned. The lexer thread is still adding to them until T_EOF though.
+    if (dumpComments)
+    {
+        size_t printed = 0;
+        token_t* token = nullptr;
+        do
+        {
+            token = s.GetToken();
+            if (!pipeline || token->type == T_EOF)
+            {
+                DumpComments(s, printed);
+            }
+        } while (token->type != T_EOF);
+        return !s.IsSourceTooLarge();
+    }
 
-    while (token->type != T_EOF)
+    if (dumpTokens)
     {
-        token = s->GetToken();
-        std::cout << "<" << token->type << ", " << token->str << ">, Line: " << token->line << " Col: " << token->col << std::endl;
+        ScannerTest(s);
+        return !s.IsSourceTooLarge();
     }
+
+    size_t tokenCount = 0;
+    token_t* token = nullptr;
+    do
+    {
+        token = s.GetToken();
+        tokenCount++;
+    } while (token->type != T_EOF);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = s.GetBytesScanned() / (1024.0 * 1024.0);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // n/a unless the allocations are counted, see COUNT_ALLOCATIONS
+    char allocations[32] = "n/a";
+#ifdef COUNT_ALLOCATIONS
+    snprintf(allocations, sizeof(allocations), "%.4f", (double)(allocationCount - allocationsBefore) / tokenCount);
+#endif
+
+    const char* simd[] = {"scalar", "sse2", "avx2"};
+    printf("%s: lexer %s/%s, %zu bytes, %zu tokens, %.2f ms, %.1f MB/s, %.2f Mtokens/s, %s allocations/token, peak RSS %ld KB\n",
+           fileName.c_str(), s.GetDfaLexer() ? "dfa" : "scanner", simd[CharClass::GetSimdLevel()], s.GetBytesScanned(), tokenCount,
+           seconds * 1000.0, megabytes / seconds, tokenCount / seconds / 1e6, allocations, usage.ru_maxrss);
+
+    if (s.GetBytesScanned() != s.GetSourceSize())
+    {
+        printf("%s: %zu bytes scanned, the source has %zu\n", fileName.c_str(), s.GetBytesScanned(), s.GetSourceSize());
+        return false;
+    }
+    return !s.IsSourceTooLarge();
 }
 
-void PeekTest(std::string fileName)
+// Lex the file with both lexer cores and report the first token they disagree on
+bool LexCompare(std::string fileName)
 {
-    Scanner* s = new Scanner();
-    s->InitScanner(fileName);
+    Scanner handWritten;
+    Scanner dfa;
+    dfa.SetDfaLexer(true);
+
+    if (!handWritten.InitScanner(fileName) || !dfa.InitScanner(fileName))
+    {
+        return false;
+    }
+
+    int count = 0;
+    token_t *a = nullptr;
+    token_t *b = nullptr;
+    do
+    {
+        a = handWritten.GetToken();
+        b = dfa.GetToken();
+        count++;
+
+        bool sameVal = true;
+        if (a->type == T_INT_LITERAL)
+        {
+            sameVal = (a->val.intValue == b->val.intValue);
+        }
+        else if (a->type == T_FLOAT_LITERAL)
+        {
+            sameVal = (a->val.floatValue == b->val.floatValue);
+        }
 
-    token_t* token = new token_t();
+        if (a->type != b->type || a->offset != b->offset || a->length != b->length || !sameVal)
+        {
+            std::cout << fileName << ": token " << count << " differs" << std::endl;
+            std::cout << "\tscanner: <" << a->type << ", " << handWritten.GetTokenText(a).str() << ">, Offset: " << a->offset << std::endl;
+            std::cout << "\tdfa:     <" << b->type << ", " << dfa.GetTokenText(b).str() << ">, Offset: " << b->offset << std::endl;
+            return false;
+        }
+    } while (a->type != T_EOF);
 
-    int i = 1;
-    while (token->type != T_EOF)
+    std::cout << fileName << ": " << count << " tokens match" << std::endl;
+    return true;
+}
+
+// --emit=obj,asm,bc,ll picks which files are written, kind=path names one (output.o, output.s,
+// output.bc and IR.ll otherwise)
+bool ParseEmit(const std::string &kinds, compile_options_t &options)
+{
+    options.emitObj.clear();
+    options.emitAsm.clear();
+    options.emitBc.clear();
+    options.emitLl.clear();
+
+    size_t start = 0;
+    while (start <= kinds.size())
     {
-        if (i % 2 == 0)
+        size_t end = kinds.find(',', start);
+        if (end == std::string::npos)
         {
-            token = s->PeekToken();
+            end = kinds.size();
         }
-        else
+        std::string kind = kinds.substr(start, end - start);
+        std::string path;
+        size_t equals = kind.find('=');
+        if (equals != std::string::npos)
         {
-            token = s->GetToken();
+            path = kind.substr(equals + 1);
+            kind = kind.substr(0, equals);
         }
 
-        std::cout << "<" << token->type << ", " << token->str << ">, Line: " << token->line << " Col: " << token->col << std::endl;
-        i++;
+        if (kind == "obj")
+        {
+            options.emitObj = path.empty() ? "output.o" : path;
+        }
+        else if (kind == "asm")
+        {
+            options.emitAsm = path.empty() ? "output.s" : path;
+        }
+        else if (kind == "bc")
+        {
+            options.emitBc = path.empty() ? "output.bc" : path;
+        }
+        else if (kind == "ll")
+        {
+            options.emitLl = path.empty() ? "IR.ll" : path;
+        }
+        else
+        {
+            std::cout << "Unknown --emit kind: " << kind << " (expected obj, asm, bc or ll)" << std::endl;
+            return false;
+        }
+        start = end + 1;
     }
+
+    return true;
 }
 
 int main(int argc, char* argv[])
 {
-    if (argc < 2)
+    std::string fileName;
+    bool lexCompare = false;
+    bool lexOnly = false;
+    bool dumpTokens = false;
+    bool dumpComments = false;
+    std::string lexer;
+    int threads = 0;
+    bool pipeline = false;
+    compile_options_t options;
+    bool emit = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--lex-compare")
+        {
+            lexCompare = true;
+        }
+        else if (arg == "--lex-only")
+        {
+            lexOnly = true;
+        }
+        else if (arg == "--dump-tokens")
+        {
+            lexOnly = true;
+            dumpTokens = true;
+        }
+        else if (arg == "--dump-comments")
+        {
+            lexOnly = true;
+            dumpComments = true;
+        }
+        else if (arg == "--lexer" && i + 1 < argc)
+        {
+            lexer = argv[++i];
+        }
+        else if (arg == "--simd" && i + 1 < argc)
+        {
+            std::string level = argv[++i];
+            if (level != "scalar" && level != "sse2" && level != "avx2")
+            {
+                std::cout << "Unknown --simd level: " << level << " (expected scalar, sse2 or avx2)" << std::endl;
+                return 1;
+            }
+            CharClass::SetSimdLevel(level == "scalar" ? SIMD_SCALAR : level == "sse2" ? SIMD_SSE2 : SIMD_AVX2);
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (arg == "--pipeline")
+        {
+            pipeline = true;
+        }
+        else if (arg == "--check")
+        {
+            options.checkOnly = true;
+        }
+        else if (arg == "--max-depth" && i + 1 < argc)
+        {
+            options.maxDepth = atoi(argv[++i]);
+        }
+        else if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' && arg[2] <= '3')
+        {
+            options.optLevel = arg[2] - '0';
+        }
+        else if (arg.compare(0, 7, "-march=") == 0)
+        {
+            options.cpu = arg.substr(7);
+        }
+        else if (arg.compare(0, 6, "-mcpu=") == 0)
+        {
+            options.cpu = arg.substr(6);
+        }
+        else if (arg.compare(0, 7, "-mattr=") == 0)
+        {
+            options.features += (options.features.empty() ? "" : ",") + arg.substr(7);
+        }
+        else if (arg.compare(0, 7, "--emit=") == 0)
+        {
+            if (!ParseEmit(arg.substr(7), options))
+            {
+                return 1;
+            }
+            emit = true;
+        }
+        else if (arg == "-o" && i + 1 < argc)
+        {
+            options.executable = argv[++i];
+        }
+        else if (arg == "--no-link-runtime")
+        {
+            options.linkRuntime = false;
+        }
+        else
+        {
+            fileName = arg;
+        }
+    }
+
+    if (fileName.empty())
     {
         std::cout << "No file found" << std::endl;
         return 0;
     }
 
-    std::string fileName = argv[1];
+    if (lexCompare)
+    {
+        return LexCompare(fileName) ? 0 : 1;
+    }
+
+    if (lexOnly)
+    {
+        return LexOnly(fileName, lexer, threads, pipeline, dumpTokens, dumpComments) ? 0 : 1;
+    }
+
     Scanner scanner;
     SymbolTable symbolTable;
+    if (!lexer.empty())
+    {
+        scanner.SetDfaLexer(lexer == "dfa");
+    }
 
     // Initialize Scanner and get first token
-    scanner.InitScanner(fileName);
+    bool opened = scanner.InitScanner(fileName);
     token_t *token = new token_t();
 
+    // Lex the whole file up front on worker threads
+    if (opened && threads > 0 && !scanner.PreTokenize(threads))
+    {
+        std::cout << "--threads ignored, streamed input is scanned one token at a time" << std::endl;
+    }
+
+    // Or lex it on a separate thread while parsing
+    if (opened && pipeline && threads <= 0 && !scanner.StartPipeline())
+    {
+        std::cout << "--pipeline ignored, streamed input is scanned one token at a time" << std::endl;
+    }
+
+    // -o links with the libruntime.a built next to the compiler, output.o is only kept if --emit asks for it
+    if (!options.executable.empty())
+    {
+        if (!emit)
+        {
+            options.emitObj.clear();
+        }
+
+        llvm::SmallString<128> archive(llvm::sys::path::parent_path(
+            llvm::sys::fs::getMainExecutable(argv[0], reinterpret_cast<void*>(&LexOnly))));
+        llvm::sys::path::append(archive, "libruntime.a");
+        options.runtimeArchive = archive.str().str();
+    }
 
-    Parser p(scanner, symbolTable, token);
+    Parser p(scanner, symbolTable, token, options);
+
+    // Errors are reported in the exit status, for hooks, editors and scripts (a streamed input
+    // that was too large was cut off, see SCANNER_MAX_SOURCE)
+    if (p.GetErrorCount() > 0 || scanner.IsSourceTooLarge())
+    {
+        return 1;
+    }
+
+    // So is an output that was asked for (output.o unless --emit or -o say otherwise) and wasn't
+    // produced: the target was unknown, or it couldn't be written or linked
+    if (p.OutputFailed())
+    {
+        return 1;
+    }
 
     return 0;
 }
\ No newline at end of file